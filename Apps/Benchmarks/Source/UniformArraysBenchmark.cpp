@@ -0,0 +1,184 @@
+// Times UniformArrays::WidenToVec4 against the scalar loop it replaced, for elements of one to four int32 or float
+// components, and the vec4 float arrays that are copied as they are. Every output is checked against the scalar
+// loop first; the process fails on a mismatch.
+
+#include <UniformArrays.h>
+
+#include <bx/simd_t.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+using namespace Babylon;
+
+namespace
+{
+    constexpr size_t MaxElementCount{1024};
+    constexpr size_t TimedElementCounts[]{1, 4, 16, 64, 256, 1024};
+
+    // Destination storage, aligned like bx::simd128_t.
+    struct alignas(16) Vec4
+    {
+        float Values[4];
+    };
+
+    bx::simd128_t* AsSimd(std::vector<Vec4>& vectors)
+    {
+        return reinterpret_cast<bx::simd128_t*>(vectors.data());
+    }
+
+    // The loop uniform arrays were widened with before, one element at a time.
+    template<int size, typename ElementT>
+    size_t ScalarWidenToVec4(const ElementT* source, size_t componentCount, bx::simd128_t* destination)
+    {
+        size_t elementCount{0};
+        for (size_t component = 0; component < componentCount; component += size)
+        {
+            float values[4]{};
+            for (size_t index = 0; index < size && component + index < componentCount; ++index)
+            {
+                values[index] = static_cast<float>(source[component + index]);
+            }
+            std::memcpy(&destination[elementCount++], values, sizeof(values));
+        }
+
+        return elementCount;
+    }
+
+    // What the uniform receives for vec4 float arrays: the array's own floats, without a scratch copy.
+    size_t CopyVec4(const float* source, size_t componentCount, bx::simd128_t* destination)
+    {
+        std::memcpy(destination, source, componentCount * sizeof(float));
+        return componentCount / 4;
+    }
+
+    template<typename ElementT>
+    std::vector<ElementT> CreateSource(size_t componentCount)
+    {
+        std::mt19937 random{static_cast<uint32_t>(componentCount)};
+        std::vector<ElementT> source(componentCount);
+        for (auto& value : source)
+        {
+            if constexpr (std::is_same_v<ElementT, int32_t>)
+            {
+                value = std::uniform_int_distribution<int32_t>{-1 << 24, 1 << 24}(random);
+            }
+            else
+            {
+                value = std::uniform_real_distribution<float>{-1000.f, 1000.f}(random);
+            }
+        }
+
+        return source;
+    }
+
+    // Runs function over the source until enough time has passed to measure, and returns nanoseconds per call.
+    template<typename FunctionT>
+    double Time(const FunctionT& function)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        size_t iterations{1};
+        while (true)
+        {
+            const auto start = Clock::now();
+            for (size_t iteration = 0; iteration < iterations; ++iteration)
+            {
+                function();
+            }
+            const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            if (elapsed > 20'000'000.0)
+            {
+                return elapsed / static_cast<double>(iterations);
+            }
+
+            iterations *= 2;
+        }
+    }
+
+    // Checks every element count from 1 to MaxElementCount, whole elements and with a trailing partial one.
+    template<int size, typename ElementT, typename FunctionT>
+    bool Check(const char* name, const FunctionT& function)
+    {
+        std::vector<Vec4> expected(MaxElementCount);
+        std::vector<Vec4> actual(MaxElementCount);
+        for (size_t elementCount = 1; elementCount <= MaxElementCount; ++elementCount)
+        {
+            for (size_t componentCount = elementCount * size - (size - 1); componentCount <= elementCount * size; ++componentCount)
+            {
+                const std::vector<ElementT> source = CreateSource<ElementT>(componentCount);
+                const size_t expectedCount = ScalarWidenToVec4<size>(source.data(), componentCount, AsSimd(expected));
+                const size_t actualCount = function(source.data(), componentCount, AsSimd(actual));
+                if (actualCount != expectedCount || std::memcmp(actual.data(), expected.data(), expectedCount * sizeof(Vec4)) != 0)
+                {
+                    std::printf("%s: output differs from the scalar loop for %zu components.\n", name, componentCount);
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    template<int size, typename ElementT, typename FunctionT>
+    bool Run(const char* name, const FunctionT& function)
+    {
+        if (!Check<size, ElementT>(name, function))
+        {
+            return false;
+        }
+
+        std::vector<Vec4> destination(MaxElementCount);
+        for (const size_t elementCount : TimedElementCounts)
+        {
+            const std::vector<ElementT> source = CreateSource<ElementT>(elementCount * size);
+            const double scalar = Time([&] {
+                ScalarWidenToVec4<size>(source.data(), source.size(), AsSimd(destination));
+            });
+            const double widened = Time([&] {
+                function(source.data(), source.size(), AsSimd(destination));
+            });
+
+            // Reading the output keeps the timed calls from being optimized away.
+            volatile float sink = destination[0].Values[0];
+            static_cast<void>(sink);
+
+            std::printf("%-8s %5zu elements: %10.1f ns scalar, %10.1f ns, %5.2fx\n", name, elementCount, scalar, widened, scalar / widened);
+        }
+
+        return true;
+    }
+
+    template<int size, typename ElementT>
+    bool RunWiden(const char* name)
+    {
+        return Run<size, ElementT>(name, [](const ElementT* source, size_t componentCount, bx::simd128_t* destination) {
+            return UniformArrays::WidenToVec4<size>(source, componentCount, destination);
+        });
+    }
+}
+
+int main()
+{
+    bool passed = true;
+    passed = RunWiden<1, float>("float") && passed;
+    passed = RunWiden<2, float>("vec2") && passed;
+    passed = RunWiden<3, float>("vec3") && passed;
+    passed = RunWiden<4, float>("vec4") && passed;
+    passed = RunWiden<1, int32_t>("int") && passed;
+    passed = RunWiden<2, int32_t>("ivec2") && passed;
+    passed = RunWiden<3, int32_t>("ivec3") && passed;
+    passed = RunWiden<4, int32_t>("ivec4") && passed;
+
+    // Only whole vec4s take the path without a copy; the others are widened like the rest.
+    passed = Run<4, float>("vec4 ref", [](const float* source, size_t componentCount, bx::simd128_t* destination) {
+        return componentCount % 4 == 0 ? CopyVec4(source, componentCount, destination) : UniformArrays::WidenToVec4<4>(source, componentCount, destination);
+    }) && passed;
+
+    return passed ? 0 : 1;
+}
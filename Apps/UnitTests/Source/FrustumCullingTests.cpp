@@ -0,0 +1,261 @@
+#include <gtest/gtest.h>
+
+#include <FrustumCulling.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace Babylon;
+
+namespace
+{
+    enum class Expected
+    {
+        Hidden,
+        Visible,
+        Either,
+    };
+
+    // Distances this close to a decision are left out of the random comparisons, since the vectorized and scalar
+    // paths add the terms of a plane distance in different orders.
+    constexpr double Tolerance{1e-3};
+
+    // Volumes are counted on either side of the thresholds of FrustumCulling.cpp: 4 volumes per SIMD test, 32 per
+    // visibility word, and 4096 per chunk, above which chunks are spread across the thread pool.
+    const size_t Counts[]{0, 1, 3, 4, 5, 31, 32, 33, 37, 63, 64, 65, 100, 4095, 4096, 4097, 4096 * 5 + 13};
+
+    std::vector<float> CreatePlanes()
+    {
+        // Six planes of a slanted box around the origin, normalized, with the origin 8 units inside each.
+        const float normals[6][3]{
+            {1.f, 0.2f, 0.1f},
+            {-1.f, 0.1f, -0.2f},
+            {0.3f, 1.f, 0.f},
+            {-0.1f, -1.f, 0.3f},
+            {0.f, 0.2f, 1.f},
+            {0.2f, -0.3f, -1.f}};
+
+        std::vector<float> planes{};
+        for (const auto& normal : normals)
+        {
+            const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            planes.insert(planes.end(), {normal[0] / length, normal[1] / length, normal[2] / length, 8.f});
+        }
+
+        return planes;
+    }
+
+    double Distance(const std::vector<float>& planes, size_t plane, double x, double y, double z)
+    {
+        return planes[plane * 4] * x + planes[plane * 4 + 1] * y + planes[plane * 4 + 2] * z + planes[plane * 4 + 3];
+    }
+
+    // A box is visible when, for every plane, one of its eight corners is inside.
+    Expected ReferenceBox(const std::vector<float>& planes, const std::vector<float>& boxes, size_t count, size_t index)
+    {
+        Expected expected{Expected::Visible};
+        for (size_t plane = 0; plane < FrustumCulling::PlaneCount; ++plane)
+        {
+            double furthest = -INFINITY;
+            for (size_t corner = 0; corner < 8; ++corner)
+            {
+                const double x = boxes[((corner & 1) ? 3 : 0) * count + index];
+                const double y = boxes[((corner & 2) ? 4 : 1) * count + index];
+                const double z = boxes[((corner & 4) ? 5 : 2) * count + index];
+                furthest = std::max(furthest, Distance(planes, plane, x, y, z));
+            }
+
+            if (furthest < -Tolerance)
+            {
+                return Expected::Hidden;
+            }
+            if (furthest < Tolerance)
+            {
+                expected = Expected::Either;
+            }
+        }
+
+        return expected;
+    }
+
+    // A sphere is visible when its center is less than its radius outside of every plane.
+    Expected ReferenceSphere(const std::vector<float>& planes, const std::vector<float>& spheres, size_t count, size_t index)
+    {
+        Expected expected{Expected::Visible};
+        for (size_t plane = 0; plane < FrustumCulling::PlaneCount; ++plane)
+        {
+            const double margin = Distance(planes, plane, spheres[index], spheres[count + index], spheres[2 * count + index]) + spheres[3 * count + index];
+            if (margin < -Tolerance)
+            {
+                return Expected::Hidden;
+            }
+            if (margin < Tolerance)
+            {
+                expected = Expected::Either;
+            }
+        }
+
+        return expected;
+    }
+
+    bool IsVisible(const std::vector<uint32_t>& visibility, size_t index)
+    {
+        return (visibility[index / 32] >> (index % 32)) & 1;
+    }
+
+    template<typename ReferenceT>
+    void ExpectMatchesReference(const std::vector<float>& planes, const std::vector<float>& volumes, size_t count, const std::vector<uint32_t>& visibility, ReferenceT reference)
+    {
+        size_t visibleCount{0};
+        size_t hiddenCount{0};
+        for (size_t index = 0; index < count; ++index)
+        {
+            const Expected expected = reference(planes, volumes, count, index);
+            if (expected != Expected::Either)
+            {
+                ASSERT_EQ(IsVisible(visibility, index), expected == Expected::Visible) << "volume " << index << " of " << count;
+                ++(expected == Expected::Visible ? visibleCount : hiddenCount);
+            }
+        }
+
+        // Bits past the last volume are clear.
+        if (count % 32 != 0)
+        {
+            EXPECT_EQ(visibility[count / 32] >> (count % 32), 0u);
+        }
+
+        // The random volumes straddle the frustum, so both outcomes are exercised.
+        if (count >= 32)
+        {
+            EXPECT_GT(visibleCount, 0u);
+            EXPECT_GT(hiddenCount, 0u);
+        }
+    }
+}
+
+TEST(FrustumCulling, BoxesMatchScalarReference)
+{
+    const std::vector<float> planes = CreatePlanes();
+    std::mt19937 random{1};
+    std::uniform_real_distribution<float> position{-14.f, 14.f};
+    std::uniform_real_distribution<float> extent{0.f, 3.f};
+
+    for (const size_t count : Counts)
+    {
+        std::vector<float> boxes(count * 6);
+        for (size_t index = 0; index < count; ++index)
+        {
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                boxes[axis * count + index] = position(random);
+                boxes[(axis + 3) * count + index] = boxes[axis * count + index] + extent(random);
+            }
+        }
+
+        // Stale bits must be overwritten.
+        std::vector<uint32_t> visibility((count + 31) / 32, 0xA5A5A5A5);
+        FrustumCulling::CullBoxes(boxes, count, planes, visibility);
+        ExpectMatchesReference(planes, boxes, count, visibility, ReferenceBox);
+    }
+}
+
+TEST(FrustumCulling, SpheresMatchScalarReference)
+{
+    const std::vector<float> planes = CreatePlanes();
+    std::mt19937 random{2};
+    std::uniform_real_distribution<float> position{-14.f, 14.f};
+    std::uniform_real_distribution<float> radius{0.f, 3.f};
+
+    for (const size_t count : Counts)
+    {
+        std::vector<float> spheres(count * 4);
+        for (size_t index = 0; index < count; ++index)
+        {
+            for (size_t component = 0; component < 3; ++component)
+            {
+                spheres[component * count + index] = position(random);
+            }
+            spheres[3 * count + index] = radius(random);
+        }
+
+        std::vector<uint32_t> visibility((count + 31) / 32, 0xA5A5A5A5);
+        FrustumCulling::CullSpheres(spheres, count, planes, visibility);
+        ExpectMatchesReference(planes, spheres, count, visibility, ReferenceSphere);
+    }
+}
+
+TEST(FrustumCulling, VolumesExactlyOnAPlane)
+{
+    // The cube from 0 to 10 on every axis, whose plane distances are computed exactly.
+    const std::vector<float> planes{
+        1.f, 0.f, 0.f, 0.f,
+        -1.f, 0.f, 0.f, 10.f,
+        0.f, 1.f, 0.f, 0.f,
+        0.f, -1.f, 0.f, 10.f,
+        0.f, 0.f, 1.f, 0.f,
+        0.f, 0.f, -1.f, 10.f};
+
+    // Boxes whose furthest corner lies exactly on a plane are inside it; spheres that only touch a plane are not.
+    // Nine volumes cover both the four-wide path and the one-at-a-time tail, with the last at index 8.
+    const size_t count{9};
+    const float boxMinX[count]{-2.f, 10.f, -2.f, 10.5f, 5.f, -2.f, 10.f, -2.5f, -2.f};
+    const float boxMaxX[count]{0.f, 12.f, -0.5f, 12.f, 5.f, 0.f, 12.f, -0.5f, 0.f};
+    const bool boxVisible[count]{true, true, false, false, true, true, true, false, true};
+
+    std::vector<float> boxes(count * 6);
+    for (size_t index = 0; index < count; ++index)
+    {
+        boxes[index] = boxMinX[index];
+        boxes[3 * count + index] = boxMaxX[index];
+        for (size_t axis = 1; axis < 3; ++axis)
+        {
+            boxes[axis * count + index] = 4.f;
+            boxes[(axis + 3) * count + index] = 6.f;
+        }
+    }
+
+    std::vector<uint32_t> visibility(1);
+    FrustumCulling::CullBoxes(boxes, count, planes, visibility);
+    for (size_t index = 0; index < count; ++index)
+    {
+        EXPECT_EQ(IsVisible(visibility, index), boxVisible[index]) << "box " << index;
+    }
+
+    const float sphereX[count]{-1.f, 11.f, -1.f, 11.f, 5.f, -1.f, 11.f, -2.f, -1.f};
+    const float sphereRadius[count]{1.f, 1.f, 1.5f, 1.5f, 1.f, 0.5f, 2.f, 2.f, 1.f};
+    const bool sphereVisible[count]{false, false, true, true, true, false, true, false, false};
+
+    std::vector<float> spheres(count * 4);
+    for (size_t index = 0; index < count; ++index)
+    {
+        spheres[index] = sphereX[index];
+        spheres[count + index] = 5.f;
+        spheres[2 * count + index] = 5.f;
+        spheres[3 * count + index] = sphereRadius[index];
+    }
+
+    FrustumCulling::CullSpheres(spheres, count, planes, visibility);
+    for (size_t index = 0; index < count; ++index)
+    {
+        EXPECT_EQ(IsVisible(visibility, index), sphereVisible[index]) << "sphere " << index;
+    }
+}
+
+TEST(FrustumCulling, ThrowsOnShortArrays)
+{
+    const std::vector<float> planes = CreatePlanes();
+    const std::vector<float> volumes(200);
+    std::vector<uint32_t> visibility(2);
+
+    // 200 floats hold 33 boxes or 50 spheres, and two words hold the visibility of 64 volumes.
+    EXPECT_THROW(FrustumCulling::CullBoxes(volumes, 34, planes, visibility), std::runtime_error);
+    EXPECT_THROW(FrustumCulling::CullSpheres(volumes, 51, planes, visibility), std::runtime_error);
+    EXPECT_THROW(FrustumCulling::CullBoxes(volumes, 33, {planes.data(), planes.size() - 1}, visibility), std::runtime_error);
+    EXPECT_THROW(FrustumCulling::CullSpheres(volumes, 33, planes, {visibility.data(), 1}), std::runtime_error);
+
+    EXPECT_NO_THROW(FrustumCulling::CullBoxes(volumes, 33, planes, visibility));
+    EXPECT_NO_THROW(FrustumCulling::CullSpheres(volumes, 50, planes, visibility));
+}
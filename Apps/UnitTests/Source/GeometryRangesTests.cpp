@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <GeometryRanges.h>
+
+#include <map>
+#include <stdexcept>
+
+using namespace Babylon;
+
+namespace
+{
+    using FreeRanges = std::map<uint32_t, uint32_t>;
+
+    void ExpectRange(const std::optional<GeometryRanges::Range>& range, uint16_t page, uint32_t start, uint32_t count)
+    {
+        ASSERT_TRUE(range.has_value());
+        EXPECT_EQ(range->Page, page);
+        EXPECT_EQ(range->Start, start);
+        EXPECT_EQ(range->Count, count);
+    }
+}
+
+TEST(GeometryRanges, AllocatesFirstFitFromTheFront)
+{
+    GeometryRanges ranges{100};
+    ranges.AddPage();
+
+    ExpectRange(ranges.Allocate(10, 0), 0, 0, 10);
+    ExpectRange(ranges.Allocate(20, 0), 0, 10, 20);
+    EXPECT_EQ(ranges.GetFreeRanges(0), (FreeRanges{{30, 70}}));
+
+    // Once the first range is returned, it is the first to fit a small allocation but not a large one.
+    ranges.Free({0, 0, 10}, 0);
+    ExpectRange(ranges.Allocate(40, 1), 0, 30, 40);
+    ExpectRange(ranges.Allocate(4, 1), 0, 0, 4);
+    EXPECT_EQ(ranges.GetFreeRanges(0), (FreeRanges{{4, 6}, {70, 30}}));
+}
+
+TEST(GeometryRanges, RejectsEmptyAndOversizedAllocations)
+{
+    GeometryRanges ranges{100};
+    ranges.AddPage();
+
+    EXPECT_FALSE(ranges.Allocate(0, 0).has_value());
+    EXPECT_FALSE(ranges.Allocate(101, 0).has_value());
+    ExpectRange(ranges.Allocate(100, 0), 0, 0, 100);
+}
+
+TEST(GeometryRanges, CoalescesFreedNeighbors)
+{
+    GeometryRanges ranges{100};
+    ranges.AddPage();
+    for (uint32_t index = 0; index < 5; ++index)
+    {
+        ExpectRange(ranges.Allocate(20, 0), 0, index * 20, 20);
+    }
+    EXPECT_TRUE(ranges.GetFreeRanges(0).empty());
+
+    // Ranges apart from each other stay apart.
+    ranges.Free({0, 20, 20}, 0);
+    ranges.Free({0, 60, 20}, 0);
+    EXPECT_FALSE(ranges.Allocate(100, 1).has_value());
+    EXPECT_EQ(ranges.GetFreeRanges(0), (FreeRanges{{20, 20}, {60, 20}}));
+
+    // A range merges with the free range after it, then with the one before it, then with both.
+    ranges.Free({0, 0, 20}, 1);
+    EXPECT_FALSE(ranges.Allocate(100, 2).has_value());
+    EXPECT_EQ(ranges.GetFreeRanges(0), (FreeRanges{{0, 40}, {60, 20}}));
+
+    ranges.Free({0, 80, 20}, 2);
+    EXPECT_FALSE(ranges.Allocate(100, 3).has_value());
+    EXPECT_EQ(ranges.GetFreeRanges(0), (FreeRanges{{0, 40}, {60, 40}}));
+
+    ranges.Free({0, 40, 20}, 3);
+    ExpectRange(ranges.Allocate(100, 4), 0, 0, 100);
+}
+
+TEST(GeometryRanges, ReusesFreedRangesFromTheNextFrameOn)
+{
+    GeometryRanges ranges{100};
+    ranges.AddPage();
+    ExpectRange(ranges.Allocate(100, 7), 0, 0, 100);
+
+    // Draws of frame 7 may still read the range, so it is not handed out again in that frame.
+    ranges.Free({0, 0, 100}, 7);
+    EXPECT_FALSE(ranges.Allocate(1, 7).has_value());
+    EXPECT_TRUE(ranges.GetFreeRanges(0).empty());
+
+    ExpectRange(ranges.Allocate(100, 8), 0, 0, 100);
+
+    // Frees of several frames are all reclaimed by the first allocation of a later frame.
+    ranges.Free({0, 0, 50}, 8);
+    ranges.Free({0, 50, 50}, 9);
+    EXPECT_FALSE(ranges.Allocate(60, 9).has_value());
+    EXPECT_EQ(ranges.GetFreeRanges(0), (FreeRanges{{0, 50}}));
+    ExpectRange(ranges.Allocate(60, 10), 0, 0, 60);
+}
+
+TEST(GeometryRanges, GrowsByPages)
+{
+    GeometryRanges ranges{100};
+    EXPECT_EQ(ranges.GetPageCount(), 0u);
+    EXPECT_FALSE(ranges.Allocate(1, 0).has_value());
+
+    EXPECT_EQ(ranges.AddPage(), 0);
+    ExpectRange(ranges.Allocate(70, 0), 0, 0, 70);
+    EXPECT_FALSE(ranges.Allocate(40, 0).has_value());
+
+    // A new page takes what the first cannot hold, while the first keeps taking what fits in it.
+    EXPECT_EQ(ranges.AddPage(), 1);
+    EXPECT_EQ(ranges.GetPageCount(), 2u);
+    ExpectRange(ranges.Allocate(40, 0), 1, 0, 40);
+    ExpectRange(ranges.Allocate(30, 0), 0, 70, 30);
+    ExpectRange(ranges.Allocate(30, 0), 1, 40, 30);
+
+    // Ranges go back to the page they came from.
+    ranges.Free({1, 0, 40}, 0);
+    EXPECT_EQ(ranges.GetFreeRanges(0), FreeRanges{});
+    EXPECT_FALSE(ranges.Allocate(50, 1).has_value());
+    EXPECT_EQ(ranges.GetFreeRanges(1), (FreeRanges{{0, 40}, {70, 30}}));
+
+    ranges.Clear();
+    EXPECT_EQ(ranges.GetPageCount(), 0u);
+    EXPECT_FALSE(ranges.Allocate(1, 2).has_value());
+}
+
+TEST(GeometryRanges, PagesAreBoundByTheirSixteenBitNumbers)
+{
+    GeometryRanges ranges{1};
+    for (size_t page = 0; page < GeometryRanges::MaxPageCount; ++page)
+    {
+        ASSERT_EQ(ranges.AddPage(), static_cast<uint16_t>(page));
+    }
+
+    EXPECT_EQ(ranges.GetPageCount(), size_t{65536});
+    EXPECT_THROW(ranges.AddPage(), std::runtime_error);
+    EXPECT_EQ(ranges.GetPageCount(), size_t{65536});
+    EXPECT_EQ(ranges.GetFreeRanges(65535), (FreeRanges{{0, 1}}));
+    ExpectRange(ranges.Allocate(1, 0), 0, 0, 1);
+}
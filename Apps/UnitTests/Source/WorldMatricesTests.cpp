@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+
+#include <WorldMatrices.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace Babylon;
+
+namespace
+{
+    struct Hierarchy
+    {
+        std::vector<float> Translations{};
+        std::vector<float> Rotations{};
+        std::vector<float> Scalings{};
+        std::vector<int32_t> Parents{};
+    };
+
+    // Babylon's Matrix.ComposeToRef(scaling, rotation, translation, result).
+    void ComposeToRef(const float* scaling, const float* rotation, const float* translation, double (&result)[16])
+    {
+        const double x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+        const double x2 = x + x, y2 = y + y, z2 = z + z;
+        const double xx = x * x2, xy = x * y2, xz = x * z2;
+        const double yy = y * y2, yz = y * z2, zz = z * z2;
+        const double wx = w * x2, wy = w * y2, wz = w * z2;
+        const double sx = scaling[0], sy = scaling[1], sz = scaling[2];
+
+        const double values[16]{
+            (1 - (yy + zz)) * sx, (xy + wz) * sx, (xz - wy) * sx, 0,
+            (xy - wz) * sy, (1 - (xx + zz)) * sy, (yz + wx) * sy, 0,
+            (xz + wy) * sz, (yz - wx) * sz, (1 - (xx + yy)) * sz, 0,
+            translation[0], translation[1], translation[2], 1};
+        std::copy(std::begin(values), std::end(values), result);
+    }
+
+    // Babylon's Matrix.multiplyToRef(other, result), which computes left * right for row vectors.
+    void MultiplyToRef(const double (&left)[16], const double (&right)[16], double (&result)[16])
+    {
+        for (size_t row = 0; row < 4; ++row)
+        {
+            for (size_t column = 0; column < 4; ++column)
+            {
+                double sum{0};
+                for (size_t index = 0; index < 4; ++index)
+                {
+                    sum += left[row * 4 + index] * right[index * 4 + column];
+                }
+                result[row * 4 + column] = sum;
+            }
+        }
+    }
+
+    // TransformNode.computeWorldMatrix: the local matrix, times the parent's world matrix when there is a parent.
+    // Parents are composed on demand, so the reference does not depend on the order of the nodes.
+    std::vector<double> Reference(const Hierarchy& hierarchy)
+    {
+        const size_t count = hierarchy.Parents.size();
+        std::vector<double> worlds(count * 16);
+        std::vector<bool> composed(count, false);
+
+        const auto compose = [&](size_t node, const auto& self) -> void {
+            if (composed[node])
+            {
+                return;
+            }
+
+            double local[16];
+            ComposeToRef(&hierarchy.Scalings[node * 3], &hierarchy.Rotations[node * 4], &hierarchy.Translations[node * 3], local);
+
+            double world[16];
+            const int32_t parent = hierarchy.Parents[node];
+            if (parent < 0)
+            {
+                std::copy(std::begin(local), std::end(local), world);
+            }
+            else
+            {
+                self(static_cast<size_t>(parent), self);
+                double parentWorld[16];
+                std::copy_n(&worlds[static_cast<size_t>(parent) * 16], 16, parentWorld);
+                MultiplyToRef(local, parentWorld, world);
+            }
+
+            std::copy(std::begin(world), std::end(world), &worlds[node * 16]);
+            composed[node] = true;
+        };
+
+        for (size_t node = 0; node < count; ++node)
+        {
+            compose(node, compose);
+        }
+
+        return worlds;
+    }
+
+    // Random transforms for the given parents, with unit quaternions and scalings away from zero.
+    Hierarchy CreateHierarchy(std::vector<int32_t> parents, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> translation{-10.f, 10.f};
+        std::uniform_real_distribution<float> component{-1.f, 1.f};
+        std::uniform_real_distribution<float> scaling{0.5f, 1.5f};
+
+        Hierarchy hierarchy{};
+        for (size_t node = 0; node < parents.size(); ++node)
+        {
+            float rotation[4]{component(random), component(random), component(random), component(random)};
+            const float length = std::sqrt(rotation[0] * rotation[0] + rotation[1] * rotation[1] + rotation[2] * rotation[2] + rotation[3] * rotation[3]);
+            for (auto& value : rotation)
+            {
+                value /= length;
+            }
+
+            hierarchy.Translations.insert(hierarchy.Translations.end(), {translation(random), translation(random), translation(random)});
+            hierarchy.Rotations.insert(hierarchy.Rotations.end(), std::begin(rotation), std::end(rotation));
+            hierarchy.Scalings.insert(hierarchy.Scalings.end(), {scaling(random), scaling(random), scaling(random)});
+        }
+        hierarchy.Parents = std::move(parents);
+
+        return hierarchy;
+    }
+
+    void ExpectMatchesReference(const Hierarchy& hierarchy)
+    {
+        const size_t count = hierarchy.Parents.size();
+        std::vector<float> worlds(count * 16, NAN);
+        WorldMatrices::Compose(hierarchy.Translations, hierarchy.Rotations, hierarchy.Scalings, hierarchy.Parents, worlds);
+
+        const std::vector<double> expected = Reference(hierarchy);
+        for (size_t index = 0; index < worlds.size(); ++index)
+        {
+            // Errors grow with the depth of the hierarchy and the size of the translations.
+            ASSERT_NEAR(worlds[index], expected[index], 1e-3 * std::max(1.0, std::abs(expected[index]))) << "node " << index / 16 << ", element " << index % 16;
+        }
+    }
+
+    // Parents of a random forest, with each node's parent at a lower index than the node.
+    std::vector<int32_t> CreateOrderedParents(size_t count, size_t rootCount, std::mt19937& random)
+    {
+        std::vector<int32_t> parents(count, -1);
+        for (size_t node = rootCount; node < count; ++node)
+        {
+            // Parents are picked among the last few nodes, so that the hierarchy gets deep.
+            const size_t first = node > 8 ? node - 8 : 0;
+            parents[node] = static_cast<int32_t>(std::uniform_int_distribution<size_t>{first, node - 1}(random));
+        }
+
+        return parents;
+    }
+
+    // The same forest with its nodes shuffled, so that children may come before their parents.
+    std::vector<int32_t> Shuffle(const std::vector<int32_t>& parents, std::mt19937& random)
+    {
+        std::vector<int32_t> position(parents.size());
+        std::iota(position.begin(), position.end(), 0);
+        std::shuffle(position.begin(), position.end(), random);
+
+        std::vector<int32_t> shuffled(parents.size());
+        for (size_t node = 0; node < parents.size(); ++node)
+        {
+            shuffled[position[node]] = parents[node] < 0 ? -1 : position[parents[node]];
+        }
+
+        return shuffled;
+    }
+}
+
+TEST(WorldMatrices, RootsMatchComposeToRef)
+{
+    std::mt19937 random{1};
+    for (const size_t count : {0, 1, 2, 5, 33})
+    {
+        ExpectMatchesReference(CreateHierarchy(std::vector<int32_t>(count, -1), random));
+    }
+}
+
+TEST(WorldMatrices, ChildrenAreMultipliedByTheirParents)
+{
+    std::mt19937 random{2};
+
+    // A single chain, then a forest.
+    ExpectMatchesReference(CreateHierarchy({-1, 0, 1, 2, 3, 4}, random));
+    ExpectMatchesReference(CreateHierarchy(CreateOrderedParents(200, 3, random), random));
+}
+
+TEST(WorldMatrices, UnorderedNodesComposeParentsFirst)
+{
+    std::mt19937 random{3};
+
+    // Children listed before their parents, down to the reverse of a chain.
+    ExpectMatchesReference(CreateHierarchy({1, 2, 3, 4, 5, -1}, random));
+    ExpectMatchesReference(CreateHierarchy({-1, 3, 1, 0, 2}, random));
+    ExpectMatchesReference(CreateHierarchy(Shuffle(CreateOrderedParents(500, 5, random), random), random));
+}
+
+TEST(WorldMatrices, LargeHierarchiesMatchReference)
+{
+    std::mt19937 random{4};
+
+    // More than the 1024 nodes per depth above which a depth is spread across the thread pool.
+    const size_t nodesPerDepth{3000};
+    std::vector<int32_t> parents(nodesPerDepth, -1);
+    for (size_t depth = 1; depth < 4; ++depth)
+    {
+        const size_t parentDepthStart = parents.size() - nodesPerDepth;
+        for (size_t node = 0; node < nodesPerDepth; ++node)
+        {
+            parents.push_back(static_cast<int32_t>(parentDepthStart + (node * 7) % nodesPerDepth));
+        }
+    }
+
+    ExpectMatchesReference(CreateHierarchy(Shuffle(parents, random), random));
+}
+
+TEST(WorldMatrices, ThrowsOnInvalidHierarchies)
+{
+    std::mt19937 random{5};
+    const auto compose = [](const Hierarchy& hierarchy) {
+        std::vector<float> worlds(hierarchy.Parents.size() * 16);
+        WorldMatrices::Compose(hierarchy.Translations, hierarchy.Rotations, hierarchy.Scalings, hierarchy.Parents, worlds);
+    };
+
+    // Cycles, including a node that is its own parent and a cycle hanging below a valid root.
+    EXPECT_THROW(compose(CreateHierarchy({0}, random)), std::runtime_error);
+    EXPECT_THROW(compose(CreateHierarchy({1, 0}, random)), std::runtime_error);
+    EXPECT_THROW(compose(CreateHierarchy({-1, 0, 3, 4, 2}, random)), std::runtime_error);
+
+    // Parents past the last node.
+    EXPECT_THROW(compose(CreateHierarchy({1}, random)), std::runtime_error);
+    EXPECT_THROW(compose(CreateHierarchy({-1, 0, 3}, random)), std::runtime_error);
+}
+
+TEST(WorldMatrices, ThrowsOnShortArrays)
+{
+    std::mt19937 random{6};
+    const Hierarchy hierarchy = CreateHierarchy({-1, 0, 1}, random);
+    std::vector<float> worlds(3 * 16);
+
+    const std::vector<float> shortVec3(8);
+    const std::vector<float> shortQuaternions(11);
+    EXPECT_THROW(WorldMatrices::Compose(shortVec3, hierarchy.Rotations, hierarchy.Scalings, hierarchy.Parents, worlds), std::runtime_error);
+    EXPECT_THROW(WorldMatrices::Compose(hierarchy.Translations, shortQuaternions, hierarchy.Scalings, hierarchy.Parents, worlds), std::runtime_error);
+    EXPECT_THROW(WorldMatrices::Compose(hierarchy.Translations, hierarchy.Rotations, shortVec3, hierarchy.Parents, worlds), std::runtime_error);
+    EXPECT_THROW(WorldMatrices::Compose(hierarchy.Translations, hierarchy.Rotations, hierarchy.Scalings, hierarchy.Parents, {worlds.data(), 47}), std::runtime_error);
+}
@@ -0,0 +1,88 @@
+// Builds a DDS file holding a BC1 image, width by height pixels, from 8-byte blocks listed row of blocks first.
+function CreateBc1Dds(width, height, blocks) {
+    var data = new Uint8Array(4 + 124 + blocks.length * 8);
+    var view = new DataView(data.buffer);
+
+    data.set([0x44, 0x44, 0x53, 0x20], 0); // "DDS "
+    view.setUint32(4, 124, true); // size
+    view.setUint32(8, 0x1 | 0x2 | 0x4 | 0x1000 | 0x80000, true); // caps, height, width, pixel format, linear size
+    view.setUint32(12, height, true);
+    view.setUint32(16, width, true);
+    view.setUint32(20, blocks.length * 8, true); // linear size
+    view.setUint32(76, 32, true); // pixel format size
+    view.setUint32(80, 0x4, true); // four cc
+    data.set([0x44, 0x58, 0x54, 0x31], 84); // "DXT1"
+    view.setUint32(108, 0x1000, true); // texture
+
+    for (var index = 0; index < blocks.length; ++index) {
+        data.set(blocks[index], 128 + index * 8);
+    }
+
+    return data;
+}
+
+// A block with 565 endpoints color0 and color1, where each entry of rows picks color0 (0) or color1 (1) for a whole
+// row of four pixels, top row first.
+function CreateBc1Block(color0, color1, rows) {
+    var block = [color0 & 0xff, color0 >> 8, color1 & 0xff, color1 >> 8];
+    for (var row = 0; row < 4; ++row) {
+        block.push(rows[row] ? 0x55 : 0x00);
+    }
+    return block;
+}
+
+var Red = 0xf800;
+var Green = 0x07e0;
+var Blue = 0x001f;
+var White = 0xffff;
+
+// Two blocks tall. From the top: red, green, green, green, blue, blue, blue, white.
+var twoBlocksTall = CreateBc1Dds(4, 8, [
+    CreateBc1Block(Red, Green, [0, 1, 1, 1]),
+    CreateBc1Block(White, Blue, [1, 1, 1, 0])]);
+
+// Six rows cannot be flipped without moving rows of pixels between blocks.
+var partlyUsedBlockRow = CreateBc1Dds(4, 6, [
+    CreateBc1Block(Red, Green, [0, 1, 1, 1]),
+    CreateBc1Block(White, Blue, [1, 1, 1, 0])]);
+
+function ExpectLoad(name, data, invertY, shouldSucceed) {
+    return new Promise(function (resolve) {
+        var texture = engine._native.createTexture();
+        engine._native.loadTexture(texture, data, false, invertY, function () {
+            console.log((shouldSucceed ? "PASS: " : "FAIL: ") + name + " loaded.");
+            engine._native.deleteTexture(texture);
+            resolve();
+        }, function () {
+            console.log((shouldSucceed ? "FAIL: " : "PASS: ") + name + " failed to load.");
+            engine._native.deleteTexture(texture);
+            resolve();
+        });
+    });
+}
+
+function CreateFlippedPlane() {
+    var plane = BABYLON.MeshBuilder.CreatePlane("plane", { width: 2, height: 4 }, scene);
+    var material = new BABYLON.StandardMaterial("material", scene);
+    material.disableLighting = true;
+    material.emissiveTexture = new BABYLON.Texture("data:compressed_flip", scene, true, true, BABYLON.Texture.NEAREST_SAMPLINGMODE, null, null, twoBlocksTall);
+    plane.material = material;
+
+    console.log("The plane should show, from the top: white, blue, blue, blue, green, green, green, red.");
+}
+
+var engine = new BABYLON.NativeEngine();
+var scene = new BABYLON.Scene(engine);
+
+ExpectLoad("Two blocks tall BC1, flipped", twoBlocksTall, true, true)
+    .then(function () { return ExpectLoad("Six rows tall BC1, not flipped", partlyUsedBlockRow, false, true); })
+    .then(function () { return ExpectLoad("Six rows tall BC1, flipped", partlyUsedBlockRow, true, false); })
+    .then(function () {
+        CreateFlippedPlane();
+        scene.createDefaultCamera(true);
+        engine.runRenderLoop(function () {
+            scene.render();
+        });
+    }, function (ex) {
+        console.log(ex.message, ex.stack);
+    });
@@ -0,0 +1,66 @@
+var Identifier = [0xab, 0x4b, 0x54, 0x58, 0x20, 0x32, 0x30, 0xbb, 0x0d, 0x0a, 0x1a, 0x0a];
+
+// The identifier, the header and the indices of the data format descriptor, key/value data and supercompression
+// global data come before the level index.
+var LevelIndexOffset = 80;
+
+// Builds a single level 2x2 KTX2 file of VkFormat R8G8B8A8_UNORM (37) or R8G8B8A8_SRGB (43). Fields of options
+// override the header and level index to make the file invalid.
+function CreateKtx2(vkFormat, options) {
+    options = options || {};
+
+    var pixels = [
+        0xff, 0x00, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff,
+        0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff];
+    var levelOffset = LevelIndexOffset + 24;
+    var data = new Uint8Array(levelOffset + pixels.length);
+    var view = new DataView(data.buffer);
+
+    data.set(Identifier, 0);
+    var header = [vkFormat, 1, 2, 2, 0, 0, 1, 1, options.supercompressionScheme || 0];
+    for (var index = 0; index < header.length; ++index) {
+        view.setUint32(12 + index * 4, header[index], true);
+    }
+
+    view.setUint32(LevelIndexOffset, options.levelOffset !== undefined ? options.levelOffset : levelOffset, true);
+    view.setUint32(LevelIndexOffset + 8, options.levelLength !== undefined ? options.levelLength : pixels.length, true);
+    view.setUint32(LevelIndexOffset + 16, pixels.length, true);
+    data.set(pixels, levelOffset);
+
+    return options.truncateTo !== undefined ? data.slice(0, options.truncateTo) : data;
+}
+
+function ExpectLoad(name, data, shouldSucceed) {
+    return new Promise(function (resolve) {
+        var texture = engine._native.createTexture();
+        engine._native.loadTexture(texture, data, false, false, function () {
+            var size = engine._native.getTextureWidth(texture) + "x" + engine._native.getTextureHeight(texture);
+            console.log((shouldSucceed ? "PASS: " : "FAIL: ") + name + " loaded at " + size + ".");
+            engine._native.deleteTexture(texture);
+            resolve();
+        }, function () {
+            console.log((shouldSucceed ? "FAIL: " : "PASS: ") + name + " failed to load.");
+            engine._native.deleteTexture(texture);
+            resolve();
+        });
+    });
+}
+
+var engine = new BABYLON.NativeEngine();
+
+var tests = [
+    ["Linear RGBA8", CreateKtx2(37), true],
+    ["sRGB RGBA8", CreateKtx2(43), true],
+    ["Truncated level index", CreateKtx2(37, { truncateTo: LevelIndexOffset + 12 }), false],
+    ["Truncated level data", CreateKtx2(37, { truncateTo: LevelIndexOffset + 24 + 8 }), false],
+    ["Zstandard supercompression", CreateKtx2(37, { supercompressionScheme: 2 }), false],
+    ["Basis Universal payload", CreateKtx2(0), false],
+    ["Level length not matching the format", CreateKtx2(37, { levelLength: 12 }), false],
+    ["Level outside of the file", CreateKtx2(37, { levelOffset: 0xfffffff0 }), false],
+];
+
+tests.reduce(function (previous, test) {
+    return previous.then(function () { return ExpectLoad(test[0], test[1], test[2]); });
+}, Promise.resolve()).then(function () {
+    console.log("KTX2 tests done.");
+});
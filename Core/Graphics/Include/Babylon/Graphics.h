@@ -2,7 +2,10 @@
 
 #include <Babylon/JsRuntime.h>
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace Babylon
 {
@@ -11,6 +14,39 @@ namespace Babylon
     public:
         class Impl;
 
+        /// Counts and timings bgfx measured for the most recently rendered frame.
+        struct FrameStats
+        {
+            struct View
+            {
+                std::string Name{};
+                uint16_t Id{};
+                double CpuTimeMs{};
+                double GpuTimeMs{};
+            };
+
+            uint32_t DrawCount{};
+            uint32_t ComputeCount{};
+            uint32_t BlitCount{};
+
+            /// Time between the last two frame submissions on the CPU.
+            double CpuFrameTimeMs{};
+            /// Time the CPU spent submitting the frame to the graphics API.
+            double CpuSubmitTimeMs{};
+            double GpuFrameTimeMs{};
+            /// Time the render thread waited for the frame, and the frame waited for the render thread.
+            double WaitRenderTimeMs{};
+            double WaitSubmitTimeMs{};
+
+            uint32_t TransientVertexBytesUsed{};
+            uint32_t TransientIndexBytesUsed{};
+            int64_t TextureMemoryUsed{};
+            int64_t RenderTargetMemoryUsed{};
+
+            /// Only filled in while view profiling is enabled.
+            std::vector<View> Views{};
+        };
+
         ~Graphics();
 
         template<typename NativeWindowT>
@@ -32,6 +68,13 @@ namespace Babylon
 
         void UpdateSize(size_t width, size_t height);
 
+        /// Returns the stats of the most recently rendered frame. Safe to call from any thread.
+        FrameStats GetFrameStats() const;
+
+        /// Measures the time each view takes on the CPU and GPU, from the next frame on. Off by default, as the
+        /// measurements themselves take time.
+        void SetViewProfilingEnabled(bool enabled);
+
     private:
         Graphics();
         Graphics(const Graphics&) = delete;
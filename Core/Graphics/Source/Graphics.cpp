@@ -45,24 +45,143 @@ namespace Babylon
             throw std::runtime_error{"Current frame cannot be finished prior to having been started."};
         }
 
-        bool finished = false;
-        bool workDone = false;
-        RenderCurrentFrameAsync(finished, workDone);
-        while (!finished)
+        std::exception_ptr exception{};
+        try
         {
-            Dispatcher.blocking_tick(arcana::cancellation::none());
-        }
+            bool finished = false;
+            bool workDone = false;
+            RenderCurrentFrameAsync(finished, workDone);
+            while (!finished)
+            {
+                Dispatcher.blocking_tick(arcana::cancellation::none());
+            }
 
-        if (workDone)
+            if (workDone)
+            {
+                SubmitFrame();
+            }
+        }
+        catch (...)
         {
-            bgfx::frame();
+            exception = std::current_exception();
         }
 
+        // The frame is over even when its work failed, so that waiters are released and the next frame can start.
         auto oldRenderTaskCompletionSource = AfterRenderTaskCompletionSource;
         AfterRenderTaskCompletionSource = {};
         oldRenderTaskCompletionSource.complete();
 
         m_rendering = false;
+
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    void Graphics::Impl::SubmitFrame()
+    {
+        // bgfx's debug flags are only changed on the thread that submits frames.
+        const bool viewProfilingEnabled = m_viewProfilingEnabled;
+        if (viewProfilingEnabled != m_viewProfiling)
+        {
+            bgfx::setDebug(viewProfilingEnabled ? BGFX_DEBUG_PROFILER : BGFX_DEBUG_NONE);
+            m_viewProfiling = viewProfilingEnabled;
+        }
+
+        Frame();
+
+        CaptureFrameStats();
+    }
+
+    void Graphics::Impl::Frame()
+    {
+        // Encoders acquired on other threads record into this frame, so they are joined before it ends.
+        {
+            std::unique_lock encodersLock{m_encodersMutex};
+            m_encodersReleased.wait(encodersLock, [this] { return m_acquiredEncoderCount == 0; });
+        }
+
+        // bgfx::frame returns the number of the frame it submitted.
+        m_frameIndex = bgfx::frame() + 1;
+    }
+
+    Graphics::FrameStats Graphics::Impl::GetFrameStats() const
+    {
+        std::scoped_lock frameStatsLock{m_frameStatsMutex};
+        return m_frameStats;
+    }
+
+    void Graphics::Impl::SetViewProfilingEnabled(bool enabled)
+    {
+        m_viewProfilingEnabled = enabled;
+    }
+
+    void Graphics::Impl::CaptureFrameStats()
+    {
+        const bgfx::Stats* stats = bgfx::getStats();
+        const double cpuTicksToMs = stats->cpuTimerFreq != 0 ? 1000.0 / static_cast<double>(stats->cpuTimerFreq) : 0.0;
+        const double gpuTicksToMs = stats->gpuTimerFreq != 0 ? 1000.0 / static_cast<double>(stats->gpuTimerFreq) : 0.0;
+
+        std::scoped_lock frameStatsLock{m_frameStatsMutex};
+        m_frameStats.DrawCount = stats->numDraw;
+        m_frameStats.ComputeCount = stats->numCompute;
+        m_frameStats.BlitCount = stats->numBlit;
+        m_frameStats.CpuFrameTimeMs = static_cast<double>(stats->cpuTimeFrame) * cpuTicksToMs;
+        m_frameStats.CpuSubmitTimeMs = static_cast<double>(stats->cpuTimeEnd - stats->cpuTimeBegin) * cpuTicksToMs;
+        m_frameStats.GpuFrameTimeMs = static_cast<double>(stats->gpuTimeEnd - stats->gpuTimeBegin) * gpuTicksToMs;
+        m_frameStats.WaitRenderTimeMs = static_cast<double>(stats->waitRender) * cpuTicksToMs;
+        m_frameStats.WaitSubmitTimeMs = static_cast<double>(stats->waitSubmit) * cpuTicksToMs;
+        m_frameStats.TransientVertexBytesUsed = static_cast<uint32_t>(stats->transientVbUsed);
+        m_frameStats.TransientIndexBytesUsed = static_cast<uint32_t>(stats->transientIbUsed);
+        m_frameStats.TextureMemoryUsed = stats->textureMemoryUsed;
+        m_frameStats.RenderTargetMemoryUsed = stats->rtMemoryUsed;
+
+        m_frameStats.Views.resize(m_viewProfiling ? stats->numViews : 0);
+        for (size_t index = 0; index < m_frameStats.Views.size(); ++index)
+        {
+            const bgfx::ViewStats& viewStats = stats->viewStats[index];
+            auto& view = m_frameStats.Views[index];
+            view.Name = viewStats.name;
+            view.Id = viewStats.view;
+            view.CpuTimeMs = static_cast<double>(viewStats.cpuTimeEnd - viewStats.cpuTimeBegin) * cpuTicksToMs;
+            view.GpuTimeMs = static_cast<double>(viewStats.gpuTimeEnd - viewStats.gpuTimeBegin) * gpuTicksToMs;
+        }
+    }
+
+    void Graphics::Impl::InitializeEncoders()
+    {
+        // Called on the thread that initialized bgfx, for which bgfx::begin returns the encoder behind its immediate API.
+        m_defaultEncoder = bgfx::begin();
+    }
+
+    bgfx::Encoder* Graphics::Impl::AcquireEncoder()
+    {
+        std::unique_lock encodersLock{m_encodersMutex};
+
+        // One of bgfx's encoders is the default one.
+        const uint32_t pooledEncoderCount = bgfx::getCaps()->limits.maxEncoders - 1;
+        m_encodersReleased.wait(encodersLock, [this, pooledEncoderCount] { return m_acquiredEncoderCount < pooledEncoderCount; });
+
+        bgfx::Encoder* encoder = bgfx::begin(true);
+        if (encoder == nullptr)
+        {
+            throw std::runtime_error{"No bgfx encoder is available."};
+        }
+
+        ++m_acquiredEncoderCount;
+        return encoder;
+    }
+
+    void Graphics::Impl::ReleaseEncoder(bgfx::Encoder* encoder)
+    {
+        {
+            std::scoped_lock encodersLock{m_encodersMutex};
+            bgfx::end(encoder);
+            --m_acquiredEncoderCount;
+        }
+
+        m_encodersReleased.notify_all();
     }
 
     arcana::task<void, std::exception_ptr> Graphics::Impl::RenderCurrentFrameAsync(bool& finished, bool& workDone)
@@ -119,7 +238,12 @@ namespace Babylon
         init.resolution.height = static_cast<uint32_t>(height);
         init.resolution.reset = BGFX_RESET_FLAGS;
         init.callback = &graphics->m_impl->Callback;
+
+        // Encoders are only pooled when bgfx is built multithreaded. Calling renderFrame before init keeps the
+        // rendering on this thread instead of letting bgfx spawn its own render thread.
+        bgfx::renderFrame();
         bgfx::init(init);
+        graphics->m_impl->InitializeEncoders();
         bgfx::setViewClear(0, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x443355FF, 1.0f, 0);
         bgfx::setViewRect(0, 0, 0, static_cast<uint16_t>(init.resolution.width), static_cast<uint16_t>(init.resolution.height));
         bgfx::touch(0);
@@ -169,9 +293,19 @@ namespace Babylon
         m_impl->FinishRenderingCurrentFrame();
     }
 
+    Graphics::FrameStats Graphics::GetFrameStats() const
+    {
+        return m_impl->GetFrameStats();
+    }
+
+    void Graphics::SetViewProfilingEnabled(bool enabled)
+    {
+        m_impl->SetViewProfilingEnabled(enabled);
+    }
+
     void Graphics::UpdateSize(size_t width, size_t height)
     {
-        m_impl->GetAfterRenderTask().then(arcana::inline_scheduler, arcana::cancellation::none(), [width, height] {
+        m_impl->GetAfterRenderTask().then(arcana::inline_scheduler, arcana::cancellation::none(), [impl = m_impl.get(), width, height] {
             const auto w = static_cast<uint16_t>(width);
             const auto h = static_cast<uint16_t>(height);
 
@@ -181,7 +315,7 @@ namespace Babylon
                 bgfx::reset(w, h, BGFX_RESET_FLAGS);
                 bgfx::setViewRect(0, 0, 0, w, h);
 #ifdef __APPLE__
-                bgfx::frame();
+                impl->Frame();
 #else
                 bgfx::touch(0);
 #endif
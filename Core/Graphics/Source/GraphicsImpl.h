@@ -9,6 +9,10 @@
 #include <bgfx/bgfx.h>
 #include <bgfx/platform.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
 namespace Babylon
 {
     class Graphics::Impl
@@ -34,11 +38,57 @@ namespace Babylon
             FinishRenderingCurrentFrame();
         }
 
+        void InitializeEncoders();
+
+        // Ends the frame that transient buffers and other per-frame allocations belong to, and captures its stats.
+        void SubmitFrame();
+
+        // Calls bgfx::frame and advances the frame index. Every bgfx::frame call goes through here, including those
+        // that only flush resource creation, since each one ends the lifetime of the frame's transient buffers.
+        // Waits for every acquired encoder to be released first.
+        void Frame();
+
+        // Number of the frame being recorded, which changes whenever bgfx::frame is called.
+        uint32_t GetFrameIndex() const
+        {
+            return m_frameIndex;
+        }
+
+        // The encoder behind bgfx's immediate API, used by the thread that drives the frame.
+        bgfx::Encoder* GetDefaultEncoder() const
+        {
+            return m_defaultEncoder;
+        }
+
+        // Encoders for recording draws in parallel on other threads. Draws recorded on an acquired encoder are part
+        // of the current frame, which is not submitted until the encoder is released. Blocks while every encoder
+        // bgfx has is in use.
+        bgfx::Encoder* AcquireEncoder();
+        void ReleaseEncoder(bgfx::Encoder* encoder);
+
+        // Stats captured when each frame is submitted, so they can be read from any thread.
+        Graphics::FrameStats GetFrameStats() const;
+        void SetViewProfilingEnabled(bool enabled);
+
         BgfxCallback Callback{};
 
     private:
+        void CaptureFrameStats();
+
         bool m_rendering{false};
 
+        std::atomic<uint32_t> m_frameIndex{};
+
+        Graphics::FrameStats m_frameStats{};
+        mutable std::mutex m_frameStatsMutex{};
+        std::atomic<bool> m_viewProfilingEnabled{false};
+        bool m_viewProfiling{false};
+
+        bgfx::Encoder* m_defaultEncoder{};
+        uint32_t m_acquiredEncoderCount{};
+        std::mutex m_encodersMutex{};
+        std::condition_variable m_encodersReleased{};
+
         arcana::manual_dispatcher<128> Dispatcher{};
         arcana::task_completion_source<void, std::exception_ptr> BeforeRenderTaskCompletionSource{};
         arcana::task_completion_source<void, std::exception_ptr> AfterRenderTaskCompletionSource{};
@@ -4,7 +4,33 @@
 
 #include <napi/env.h>
 
+#include <cstdint>
+
 namespace Babylon::Plugins::NativeEngine
 {
     void Initialize(Napi::Env env, bool renderAutomatically = true);
+
+    /// GPU resources held by NativeEngine, summed over every engine in the process. Bytes are estimates of the
+    /// GPU memory each resource occupies; peaks are the highest values reached since the process started.
+    struct ResourceStats
+    {
+        struct Counter
+        {
+            uint64_t Count{};
+            uint64_t Bytes{};
+            uint64_t PeakCount{};
+            uint64_t PeakBytes{};
+        };
+
+        Counter Textures{};
+        Counter IndexBuffers{};
+        Counter VertexBuffers{};
+        Counter InstanceBuffers{};
+        Counter StorageBuffers{};
+        Counter FrameBuffers{};
+        Counter Programs{};
+    };
+
+    /// Returns the current resource totals. Safe to call from any thread.
+    ResourceStats GetResourceStats();
 }
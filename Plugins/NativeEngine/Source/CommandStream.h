@@ -0,0 +1,234 @@
+#pragma once
+
+#include <napi/napi.h>
+
+#include <gsl/gsl>
+
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Babylon
+{
+    struct FrameBufferData;
+    struct ProgramData;
+    struct TextureData;
+    struct UniformInfo;
+    struct VertexArray;
+
+    /// Opcodes understood by NativeEngine::SubmitCommands. Each command is a uint32 opcode
+    /// followed by its arguments, every one of which occupies one or more 4-byte words:
+    ///
+    ///     object  uint32 index into the array of objects of the argument's type, one of the
+    ///             CommandObjects arrays passed alongside the command buffer
+    ///     uint32  unsigned integer
+    ///     int32   signed integer
+    ///     float   32-bit float
+    ///     bool    uint32, zero is false and anything else is true
+    ///     array   uint32 element count followed by that many 4-byte elements
+    ///
+    /// The values of this enumeration are exposed to JavaScript as COMMAND_* constants on
+    /// the engine, so they must never be reordered or reused.
+    enum class Command : uint32_t
+    {
+        BindVertexArray = 0,        // object vertexArray
+        SetProgram,                 // object program
+        SetState,                   // bool culling, float zOffset, bool reverseSide
+        Reserved,                   // formerly SetZOffset, rejected since bgfx has no depth bias to apply it to
+        SetDepthTest,               // uint32 depthTest
+        SetDepthWrite,              // bool enable
+        SetColorWrite,              // bool enable
+        SetBlendMode,               // uint32 blendMode
+        SetMatrix,                  // object uniform, float[16]
+        SetMatrix3x3,               // object uniform, float[9]
+        SetMatrix2x2,               // object uniform, float[4]
+        SetMatrices,                // object uniform, float[16 * n]
+        SetInt,                     // object uniform, int32 value
+        SetIntArray,                // object uniform, int32[]
+        SetIntArray2,               // object uniform, int32[]
+        SetIntArray3,               // object uniform, int32[]
+        SetIntArray4,               // object uniform, int32[]
+        SetFloatArray,              // object uniform, float[]
+        SetFloatArray2,             // object uniform, float[]
+        SetFloatArray3,             // object uniform, float[]
+        SetFloatArray4,             // object uniform, float[]
+        SetFloat,                   // object uniform, float x
+        SetFloat2,                  // object uniform, float x, float y
+        SetFloat3,                  // object uniform, float x, float y, float z
+        SetFloat4,                  // object uniform, float x, float y, float z, float w
+        SetTexture,                 // object uniform, object texture
+        SetTextureSampling,         // object texture, uint32 filter
+        SetTextureWrapMode,         // object texture, uint32 u, uint32 v, uint32 w
+        SetTextureAnisotropicLevel, // object texture, uint32 level
+        BindFrameBuffer,            // object frameBuffer
+        UnbindFrameBuffer,          // object frameBuffer
+        DrawIndexed,                // int32 fillMode, uint32 elementStart, uint32 elementCount
+        Draw,                       // int32 fillMode, uint32 elementStart, uint32 elementCount
+        Clear,                      // uint32 flags
+        ClearColor,                 // float r, float g, float b, float a
+        ClearDepth,                 // float depth
+        ClearStencil,               // uint32 stencil
+        SetViewPort,                // float x, float y, float width, float height
+
+        Count
+    };
+
+    /// The objects that commands refer to, in one array per type, so that an index can only
+    /// ever resolve to an object of the type the command expects.
+    struct CommandObjects final
+    {
+        Napi::Array VertexArrays;
+        Napi::Array Programs;
+        Napi::Array Uniforms;
+        Napi::Array Textures;
+        Napi::Array FrameBuffers;
+    };
+
+    /// Sequential, bounds-checked reader over a command buffer produced by the JavaScript
+    /// side of NativeEngine. Arrays are returned as spans rather than copied, so a buffer
+    /// that is not 4-byte aligned, such as a view at an odd byteOffset, is first copied
+    /// into aligned storage owned by the stream; aligned buffers are read in place.
+    class CommandStream final
+    {
+    public:
+        CommandStream(const uint8_t* data, size_t byteLength, CommandObjects objects)
+            : m_data{data}
+            , m_byteLength{byteLength}
+            , m_objects{objects}
+        {
+            if (m_byteLength % sizeof(uint32_t) != 0)
+            {
+                throw std::runtime_error{"Command buffers must be a multiple of 4 bytes long."};
+            }
+
+            if (reinterpret_cast<uintptr_t>(m_data) % alignof(uint32_t) != 0)
+            {
+                m_alignedCopy.resize(m_byteLength / sizeof(uint32_t));
+                std::memcpy(m_alignedCopy.data(), data, m_byteLength);
+                m_data = reinterpret_cast<const uint8_t*>(m_alignedCopy.data());
+            }
+        }
+
+        CommandStream(const CommandStream&) = delete;
+        CommandStream& operator=(const CommandStream&) = delete;
+
+        bool AtEnd() const
+        {
+            return m_position == m_byteLength;
+        }
+
+        Command ReadCommand()
+        {
+            const auto command = ReadUint32();
+            if (command >= static_cast<uint32_t>(Command::Count))
+            {
+                throw std::runtime_error{"Unrecognized command in command buffer."};
+            }
+
+            return static_cast<Command>(command);
+        }
+
+        uint32_t ReadUint32()
+        {
+            return Read<uint32_t>();
+        }
+
+        int32_t ReadInt32()
+        {
+            return Read<int32_t>();
+        }
+
+        float ReadFloat()
+        {
+            return Read<float>();
+        }
+
+        bool ReadBool()
+        {
+            return Read<uint32_t>() != 0;
+        }
+
+        template<typename ElementT>
+        gsl::span<const ElementT> ReadArray()
+        {
+            static_assert(sizeof(ElementT) == sizeof(uint32_t));
+
+            // Compared in elements, since the byte length can overflow size_t where it is 32 bits wide.
+            const size_t count = ReadUint32();
+            if (count > (m_byteLength - m_position) / sizeof(ElementT))
+            {
+                throw std::runtime_error{"Unexpected end of command buffer."};
+            }
+
+            const auto* data = reinterpret_cast<const ElementT*>(m_data + m_position);
+            m_position += count * sizeof(ElementT);
+            return gsl::make_span(data, count);
+        }
+
+        template<typename T>
+        T* ReadObject()
+        {
+            const Napi::Array& objects = GetObjects<T>();
+            const auto index = ReadUint32();
+            if (index >= objects.Length())
+            {
+                throw std::runtime_error{"Object index out of range in command buffer."};
+            }
+
+            return objects.Get(index).As<Napi::External<T>>().Data();
+        }
+
+    private:
+        template<typename T>
+        const Napi::Array& GetObjects() const
+        {
+            if constexpr (std::is_same_v<T, VertexArray>)
+            {
+                return m_objects.VertexArrays;
+            }
+            else if constexpr (std::is_same_v<T, ProgramData>)
+            {
+                return m_objects.Programs;
+            }
+            else if constexpr (std::is_same_v<T, UniformInfo>)
+            {
+                return m_objects.Uniforms;
+            }
+            else if constexpr (std::is_same_v<T, TextureData>)
+            {
+                return m_objects.Textures;
+            }
+            else
+            {
+                static_assert(std::is_same_v<T, FrameBufferData>, "Commands only refer to the object types of CommandObjects.");
+                return m_objects.FrameBuffers;
+            }
+        }
+
+        template<typename T>
+        T Read()
+        {
+            EnsureAvailable(sizeof(T));
+
+            T value;
+            std::memcpy(&value, m_data + m_position, sizeof(T));
+            m_position += sizeof(T);
+            return value;
+        }
+
+        void EnsureAvailable(size_t byteLength) const
+        {
+            if (byteLength > m_byteLength - m_position)
+            {
+                throw std::runtime_error{"Unexpected end of command buffer."};
+            }
+        }
+
+        const uint8_t* m_data{};
+        size_t m_byteLength{};
+        size_t m_position{0};
+        CommandObjects m_objects;
+        std::vector<uint32_t> m_alignedCopy{};
+    };
+}
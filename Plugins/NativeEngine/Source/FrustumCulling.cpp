@@ -0,0 +1,213 @@
+#include "FrustumCulling.h"
+#include "ParallelFor.h"
+
+#include <bx/simd_t.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Babylon::FrustumCulling
+{
+    namespace
+    {
+        // Below this many volumes per thread the thread pool costs more than it saves.
+        constexpr size_t MinChunkSize{4096};
+
+        bx::simd128_t LoadUnaligned(const float* source)
+        {
+            // Typed arrays are only 4-byte aligned; the copy compiles to an unaligned load.
+            alignas(16) float values[4];
+            std::memcpy(values, source, sizeof(values));
+            return bx::simd_ld(values);
+        }
+
+        struct Planes
+        {
+            explicit Planes(gsl::span<const float> planes)
+            {
+                if (static_cast<size_t>(planes.size()) < PlaneFloatCount)
+                {
+                    throw std::runtime_error{"Frustum culling needs six planes of four floats."};
+                }
+
+                for (size_t plane = 0; plane < PlaneCount; ++plane)
+                {
+                    for (size_t component = 0; component < 4; ++component)
+                    {
+                        Scalar[plane][component] = planes[plane * 4 + component];
+                        Splat[plane][component] = bx::simd_splat(Scalar[plane][component]);
+                    }
+                }
+            }
+
+            float Scalar[PlaneCount][4]{};
+            bx::simd128_t Splat[PlaneCount][4]{};
+        };
+
+        class BoxTest final
+        {
+        public:
+            BoxTest(gsl::span<const float> boxes, size_t count, gsl::span<const float> planes)
+                : m_planes{planes}
+            {
+                if (static_cast<size_t>(boxes.size()) / 6 < count)
+                {
+                    throw std::runtime_error{"Bounding box array is smaller than six floats per box."};
+                }
+
+                for (size_t axis = 0; axis < 3; ++axis)
+                {
+                    m_min[axis] = boxes.data() + axis * count;
+                    m_max[axis] = boxes.data() + (axis + 3) * count;
+                }
+            }
+
+            uint32_t Test4(size_t index) const
+            {
+                bx::simd128_t visible = bx::simd_isplat(UINT32_MAX);
+                for (size_t plane = 0; plane < PlaneCount; ++plane)
+                {
+                    // The corner furthest along the plane normal is outside only if the whole box is.
+                    const auto& splat = m_planes.Splat[plane];
+                    const auto& scalar = m_planes.Scalar[plane];
+                    const bx::simd128_t x = LoadUnaligned((scalar[0] >= 0.f ? m_max[0] : m_min[0]) + index);
+                    const bx::simd128_t y = LoadUnaligned((scalar[1] >= 0.f ? m_max[1] : m_min[1]) + index);
+                    const bx::simd128_t z = LoadUnaligned((scalar[2] >= 0.f ? m_max[2] : m_min[2]) + index);
+                    const bx::simd128_t distance = bx::simd_madd(x, splat[0], bx::simd_madd(y, splat[1], bx::simd_madd(z, splat[2], splat[3])));
+                    visible = bx::simd_and(visible, bx::simd_cmpge(distance, bx::simd_zero()));
+                }
+
+                return static_cast<uint32_t>(bx::simd_signbits(visible));
+            }
+
+            uint32_t Test1(size_t index) const
+            {
+                for (size_t plane = 0; plane < PlaneCount; ++plane)
+                {
+                    const auto& scalar = m_planes.Scalar[plane];
+                    const float x = (scalar[0] >= 0.f ? m_max[0] : m_min[0])[index];
+                    const float y = (scalar[1] >= 0.f ? m_max[1] : m_min[1])[index];
+                    const float z = (scalar[2] >= 0.f ? m_max[2] : m_min[2])[index];
+                    if (x * scalar[0] + y * scalar[1] + z * scalar[2] + scalar[3] < 0.f)
+                    {
+                        return 0;
+                    }
+                }
+
+                return 1;
+            }
+
+        private:
+            Planes m_planes;
+            const float* m_min[3]{};
+            const float* m_max[3]{};
+        };
+
+        class SphereTest final
+        {
+        public:
+            SphereTest(gsl::span<const float> spheres, size_t count, gsl::span<const float> planes)
+                : m_planes{planes}
+            {
+                if (static_cast<size_t>(spheres.size()) / 4 < count)
+                {
+                    throw std::runtime_error{"Bounding sphere array is smaller than four floats per sphere."};
+                }
+
+                for (size_t component = 0; component < 4; ++component)
+                {
+                    m_components[component] = spheres.data() + component * count;
+                }
+            }
+
+            uint32_t Test4(size_t index) const
+            {
+                const bx::simd128_t x = LoadUnaligned(m_components[0] + index);
+                const bx::simd128_t y = LoadUnaligned(m_components[1] + index);
+                const bx::simd128_t z = LoadUnaligned(m_components[2] + index);
+                const bx::simd128_t negativeRadius = bx::simd_neg(LoadUnaligned(m_components[3] + index));
+
+                bx::simd128_t visible = bx::simd_isplat(UINT32_MAX);
+                for (size_t plane = 0; plane < PlaneCount; ++plane)
+                {
+                    const auto& splat = m_planes.Splat[plane];
+                    const bx::simd128_t distance = bx::simd_madd(x, splat[0], bx::simd_madd(y, splat[1], bx::simd_madd(z, splat[2], splat[3])));
+                    visible = bx::simd_and(visible, bx::simd_cmpgt(distance, negativeRadius));
+                }
+
+                return static_cast<uint32_t>(bx::simd_signbits(visible));
+            }
+
+            uint32_t Test1(size_t index) const
+            {
+                const float x = m_components[0][index];
+                const float y = m_components[1][index];
+                const float z = m_components[2][index];
+                const float radius = m_components[3][index];
+
+                for (size_t plane = 0; plane < PlaneCount; ++plane)
+                {
+                    const auto& scalar = m_planes.Scalar[plane];
+                    if (x * scalar[0] + y * scalar[1] + z * scalar[2] + scalar[3] <= -radius)
+                    {
+                        return 0;
+                    }
+                }
+
+                return 1;
+            }
+
+        private:
+            Planes m_planes;
+            const float* m_components[4]{};
+        };
+
+        // Writes the visibility words covering volumes [begin, end); begin must be a multiple of 32.
+        template<typename TestT>
+        void CullRange(const TestT& test, size_t begin, size_t end, uint32_t* visibility)
+        {
+            for (size_t first = begin; first < end; first += 32)
+            {
+                const size_t last = std::min(first + 32, end);
+
+                uint32_t bits{0};
+                size_t index = first;
+                for (; index + 4 <= last; index += 4)
+                {
+                    bits |= test.Test4(index) << (index - first);
+                }
+                for (; index < last; ++index)
+                {
+                    bits |= test.Test1(index) << (index - first);
+                }
+
+                visibility[first / 32] = bits;
+            }
+        }
+
+        template<typename TestT>
+        void Cull(const TestT& test, size_t count, gsl::span<uint32_t> visibility)
+        {
+            if (static_cast<size_t>(visibility.size()) < (count + 31) / 32)
+            {
+                throw std::runtime_error{"Visibility array is smaller than one bit per volume."};
+            }
+
+            // Chunks start on multiples of 32 volumes so that no two threads write the same visibility word.
+            ParallelFor(count, MinChunkSize, 32, [&test, data = visibility.data()](size_t begin, size_t end) {
+                CullRange(test, begin, end, data);
+            });
+        }
+    }
+
+    void CullBoxes(gsl::span<const float> boxes, size_t count, gsl::span<const float> planes, gsl::span<uint32_t> visibility)
+    {
+        Cull(BoxTest{boxes, count, planes}, count, visibility);
+    }
+
+    void CullSpheres(gsl::span<const float> spheres, size_t count, gsl::span<const float> planes, gsl::span<uint32_t> visibility)
+    {
+        Cull(SphereTest{spheres, count, planes}, count, visibility);
+    }
+}
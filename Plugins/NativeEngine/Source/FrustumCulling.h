@@ -0,0 +1,27 @@
+#pragma once
+
+#include <gsl/gsl>
+
+#include <cstdint>
+
+namespace Babylon
+{
+    /// Tests of bounding volumes against the six planes of a view frustum, vectorized with bx's SIMD types and
+    /// spread across the thread pool for large counts.
+    ///
+    /// Volumes are laid out as structures of arrays: each component is stored for every volume before the next
+    /// component. Planes are 24 floats, (a, b, c, d) for each plane, with a point p inside a plane when
+    /// a * p.x + b * p.y + c * p.z + d >= 0, as Babylon computes them. Visibility is written as one bit per
+    /// volume, in 32-bit words, set when the volume is at least partly inside every plane.
+    namespace FrustumCulling
+    {
+        constexpr size_t PlaneCount{6};
+        constexpr size_t PlaneFloatCount{PlaneCount * 4};
+
+        /// Culls axis-aligned boxes given as minX, minY, minZ, maxX, maxY and maxZ arrays of count floats each.
+        void CullBoxes(gsl::span<const float> boxes, size_t count, gsl::span<const float> planes, gsl::span<uint32_t> visibility);
+
+        /// Culls spheres given as centerX, centerY, centerZ and radius arrays of count floats each.
+        void CullSpheres(gsl::span<const float> spheres, size_t count, gsl::span<const float> planes, gsl::span<uint32_t> visibility);
+    }
+}
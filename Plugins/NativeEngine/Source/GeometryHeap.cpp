@@ -0,0 +1,181 @@
+#include "GeometryHeap.h"
+
+#include <stdexcept>
+
+namespace Babylon
+{
+    GeometryHeap::GeometryHeap(const Graphics::Impl& graphicsImpl, const bgfx::VertexLayout& layout)
+        : m_graphicsImpl{graphicsImpl}
+        , m_indices{false}
+        , m_layout{layout}
+        , m_indexFlags{BGFX_BUFFER_NONE}
+        , m_ranges{layout.getStride() == 0 ? 0 : PageByteSize / layout.getStride()}
+    {
+    }
+
+    GeometryHeap::GeometryHeap(const Graphics::Impl& graphicsImpl, uint16_t indexFlags)
+        : m_graphicsImpl{graphicsImpl}
+        , m_indices{true}
+        , m_layout{}
+        , m_indexFlags{indexFlags}
+        , m_ranges{PageByteSize / ((indexFlags & BGFX_BUFFER_INDEX32) != 0 ? 4 : 2)}
+    {
+    }
+
+    GeometryHeap::~GeometryHeap()
+    {
+        Dispose();
+    }
+
+    std::optional<GeometryHeap::Allocation> GeometryHeap::Allocate(uint32_t count)
+    {
+        if (m_disposed || count == 0 || count > m_ranges.GetPageElementCount())
+        {
+            return {};
+        }
+
+        const uint32_t frameIndex = m_graphicsImpl.GetFrameIndex();
+        std::optional<GeometryRanges::Range> range = m_ranges.Allocate(count, frameIndex);
+        if (!range)
+        {
+            // The buffer is created first so that a failure leaves the ranges as they were.
+            const uint16_t handle = CreatePageBuffer();
+            try
+            {
+                m_ranges.AddPage();
+            }
+            catch (...)
+            {
+                DestroyPageBuffer(handle);
+                throw;
+            }
+            m_pageHandles.push_back(handle);
+
+            range = m_ranges.Allocate(count, frameIndex);
+            if (!range)
+            {
+                throw std::runtime_error{"Geometry heap page could not hold an allocation that fits a page."};
+            }
+        }
+
+        return Allocation{range->Page, m_pageHandles[range->Page], range->Start, range->Count};
+    }
+
+    void GeometryHeap::Free(const Allocation& allocation)
+    {
+        if (m_disposed)
+        {
+            return;
+        }
+
+        m_ranges.Free({allocation.Page, allocation.Start, allocation.Count}, m_graphicsImpl.GetFrameIndex());
+    }
+
+    void GeometryHeap::Update(const Allocation& allocation, const bgfx::Memory* memory) const
+    {
+        if (m_indices)
+        {
+            bgfx::update(bgfx::DynamicIndexBufferHandle{allocation.Handle}, allocation.Start, memory);
+        }
+        else
+        {
+            bgfx::update(bgfx::DynamicVertexBufferHandle{allocation.Handle}, allocation.Start, memory);
+        }
+    }
+
+    void GeometryHeap::Dispose()
+    {
+        if (m_disposed)
+        {
+            return;
+        }
+
+        for (const uint16_t handle : m_pageHandles)
+        {
+            DestroyPageBuffer(handle);
+        }
+
+        m_pageHandles.clear();
+        m_ranges.Clear();
+        m_disposed = true;
+    }
+
+    uint16_t GeometryHeap::CreatePageBuffer() const
+    {
+        if (m_indices)
+        {
+            const bgfx::DynamicIndexBufferHandle handle = bgfx::createDynamicIndexBuffer(m_ranges.GetPageElementCount(), m_indexFlags);
+            if (!bgfx::isValid(handle))
+            {
+                throw std::runtime_error{"Failed to create a geometry heap index buffer."};
+            }
+            return handle.idx;
+        }
+
+        const bgfx::DynamicVertexBufferHandle handle = bgfx::createDynamicVertexBuffer(m_ranges.GetPageElementCount(), m_layout);
+        if (!bgfx::isValid(handle))
+        {
+            throw std::runtime_error{"Failed to create a geometry heap vertex buffer."};
+        }
+        return handle.idx;
+    }
+
+    void GeometryHeap::DestroyPageBuffer(uint16_t handle) const
+    {
+        if (m_indices)
+        {
+            bgfx::destroy(bgfx::DynamicIndexBufferHandle{handle});
+        }
+        else
+        {
+            bgfx::destroy(bgfx::DynamicVertexBufferHandle{handle});
+        }
+    }
+
+    GeometryHeaps::GeometryHeaps(const Graphics::Impl& graphicsImpl)
+        : m_graphicsImpl{graphicsImpl}
+    {
+    }
+
+    std::shared_ptr<GeometryHeap> GeometryHeaps::GetVertexHeap(const bgfx::VertexLayout& layout)
+    {
+        auto& heap = m_vertexHeaps[layout.getStride()];
+        if (!heap)
+        {
+            heap = std::make_shared<GeometryHeap>(m_graphicsImpl, layout);
+        }
+
+        return heap;
+    }
+
+    std::shared_ptr<GeometryHeap> GeometryHeaps::GetIndexHeap(uint16_t indexFlags)
+    {
+        const bool index32 = (indexFlags & BGFX_BUFFER_INDEX32) != 0;
+        auto& heap = index32 ? m_index32Heap : m_index16Heap;
+        if (!heap)
+        {
+            heap = std::make_shared<GeometryHeap>(m_graphicsImpl, static_cast<uint16_t>(index32 ? BGFX_BUFFER_INDEX32 : BGFX_BUFFER_NONE));
+        }
+
+        return heap;
+    }
+
+    void GeometryHeaps::Dispose()
+    {
+        for (const auto& entry : m_vertexHeaps)
+        {
+            entry.second->Dispose();
+        }
+        m_vertexHeaps.clear();
+
+        for (const auto& heap : {m_index16Heap, m_index32Heap})
+        {
+            if (heap)
+            {
+                heap->Dispose();
+            }
+        }
+        m_index16Heap.reset();
+        m_index32Heap.reset();
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "GeometryRanges.h"
+
+#include <GraphicsImpl.h>
+
+#include <bgfx/bgfx.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Babylon
+{
+    /// Sub-allocates ranges of a few large bgfx dynamic buffers, so that scenes with many small meshes do not spend
+    /// a vertex or index buffer handle, and the driver overhead of a buffer, on every mesh.
+    ///
+    /// A heap holds either vertices of one stride or indices of one size, and measures its ranges in those elements.
+    /// Pages are added as the heap fills up and are kept until the heap is disposed of. The ranges are kept by
+    /// GeometryRanges, which only reuses a freed range once the frame that freed it has been submitted, since draws
+    /// recorded earlier in that frame may still read it while the updates for the next frame are applied.
+    class GeometryHeap final
+    {
+    public:
+        /// Size of each page. It is larger than the blocks bgfx pools its own dynamic buffers in, so every page is
+        /// a buffer of its own that starts at its first byte.
+        static constexpr uint32_t PageByteSize{4 * 1024 * 1024};
+
+        struct Allocation
+        {
+            uint16_t Page{};
+            uint16_t Handle{bgfx::kInvalidHandle};
+            uint32_t Start{};
+            uint32_t Count{};
+        };
+
+        /// Creates a heap of dynamic vertex buffers with the stride of layout.
+        GeometryHeap(const Graphics::Impl& graphicsImpl, const bgfx::VertexLayout& layout);
+
+        /// Creates a heap of dynamic index buffers, of 32-bit indices when indexFlags has BGFX_BUFFER_INDEX32.
+        GeometryHeap(const Graphics::Impl& graphicsImpl, uint16_t indexFlags);
+
+        ~GeometryHeap();
+
+        GeometryHeap(const GeometryHeap&) = delete;
+        GeometryHeap& operator=(const GeometryHeap&) = delete;
+
+        /// Allocates count elements, or returns nothing when they do not fit in a page or the heap was disposed of.
+        std::optional<Allocation> Allocate(uint32_t count);
+
+        /// Returns the range of allocation to the heap once the current frame has been submitted.
+        void Free(const Allocation& allocation);
+
+        /// Writes memory over the elements of allocation, starting at its first element.
+        void Update(const Allocation& allocation, const bgfx::Memory* memory) const;
+
+        /// Destroys the pages, after which freeing does nothing. Buffers can hold on to the heap past the engine,
+        /// and so past bgfx::shutdown, so their bgfx resources are released here instead of by the destructor.
+        void Dispose();
+
+    private:
+        uint16_t CreatePageBuffer() const;
+        void DestroyPageBuffer(uint16_t handle) const;
+
+        const Graphics::Impl& m_graphicsImpl;
+        const bool m_indices;
+        const bgfx::VertexLayout m_layout;
+        const uint16_t m_indexFlags;
+        GeometryRanges m_ranges;
+        std::vector<uint16_t> m_pageHandles{};
+        bool m_disposed{false};
+    };
+
+    /// The heaps static geometry is sub-allocated from, one for each vertex stride and index size, created as they
+    /// are first needed.
+    class GeometryHeaps final
+    {
+    public:
+        explicit GeometryHeaps(const Graphics::Impl& graphicsImpl);
+
+        std::shared_ptr<GeometryHeap> GetVertexHeap(const bgfx::VertexLayout& layout);
+        std::shared_ptr<GeometryHeap> GetIndexHeap(uint16_t indexFlags);
+
+        /// Disposes of every heap, which must happen before bgfx::shutdown.
+        void Dispose();
+
+    private:
+        const Graphics::Impl& m_graphicsImpl;
+        std::unordered_map<uint16_t, std::shared_ptr<GeometryHeap>> m_vertexHeaps{};
+        std::shared_ptr<GeometryHeap> m_index16Heap{};
+        std::shared_ptr<GeometryHeap> m_index32Heap{};
+    };
+}
@@ -0,0 +1,109 @@
+#include "GeometryRanges.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace Babylon
+{
+    GeometryRanges::GeometryRanges(uint32_t pageElementCount)
+        : m_pageElementCount{pageElementCount}
+    {
+    }
+
+    std::optional<GeometryRanges::Range> GeometryRanges::Allocate(uint32_t count, uint32_t frameIndex)
+    {
+        if (count == 0 || count > m_pageElementCount)
+        {
+            return {};
+        }
+
+        ReclaimPendingFrees(frameIndex);
+
+        // First fit, taking the front of the range so the rest stays in one piece.
+        for (size_t page = 0; page < m_pages.size(); ++page)
+        {
+            auto& freeRanges = m_pages[page];
+            for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+            {
+                const auto [start, freeCount] = *it;
+                if (freeCount < count)
+                {
+                    continue;
+                }
+
+                freeRanges.erase(it);
+                if (freeCount > count)
+                {
+                    freeRanges.emplace(start + count, freeCount - count);
+                }
+
+                return Range{static_cast<uint16_t>(page), start, count};
+            }
+        }
+
+        return {};
+    }
+
+    uint16_t GeometryRanges::AddPage()
+    {
+        if (m_pages.size() >= MaxPageCount)
+        {
+            throw std::runtime_error{"Too many geometry heap pages."};
+        }
+
+        m_pages.emplace_back().emplace(0, m_pageElementCount);
+        return static_cast<uint16_t>(m_pages.size() - 1);
+    }
+
+    void GeometryRanges::Free(const Range& range, uint32_t frameIndex)
+    {
+        m_pendingFrees.push_back({range, frameIndex});
+    }
+
+    void GeometryRanges::Clear()
+    {
+        m_pages.clear();
+        m_pendingFrees.clear();
+    }
+
+    void GeometryRanges::ReclaimPendingFrees(uint32_t frameIndex)
+    {
+        const auto reclaimed = std::partition(m_pendingFrees.begin(), m_pendingFrees.end(), [frameIndex](const PendingFree& pendingFree) {
+            return pendingFree.FrameIndex == frameIndex;
+        });
+
+        for (auto it = reclaimed; it != m_pendingFrees.end(); ++it)
+        {
+            AddFreeRange(it->Freed.Page, it->Freed.Start, it->Freed.Count);
+        }
+
+        m_pendingFrees.erase(reclaimed, m_pendingFrees.end());
+    }
+
+    void GeometryRanges::AddFreeRange(uint16_t page, uint32_t start, uint32_t count)
+    {
+        auto& freeRanges = m_pages[page];
+        auto next = freeRanges.lower_bound(start);
+
+        // Merge with the ranges directly before and after, so large allocations can use the space again.
+        if (next != freeRanges.begin())
+        {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == start)
+            {
+                start = previous->first;
+                count += previous->second;
+                freeRanges.erase(previous);
+            }
+        }
+
+        if (next != freeRanges.end() && start + count == next->first)
+        {
+            count += next->second;
+            freeRanges.erase(next);
+        }
+
+        freeRanges.emplace(start, count);
+    }
+}
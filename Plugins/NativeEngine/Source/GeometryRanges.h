@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace Babylon
+{
+    /// The range bookkeeping of GeometryHeap, without the buffers behind it, so that it can be tested without bgfx.
+    ///
+    /// Ranges are measured in elements within pages of a fixed element count. Free ranges are allocated first fit,
+    /// from their front, and merged with their neighbors when returned. A freed range is only returned once a later
+    /// frame allocates, since draws recorded in the frame that freed it may still read it.
+    class GeometryRanges final
+    {
+    public:
+        /// Pages are numbered with 16 bits.
+        static constexpr size_t MaxPageCount{size_t{std::numeric_limits<uint16_t>::max()} + 1};
+
+        struct Range
+        {
+            uint16_t Page{};
+            uint32_t Start{};
+            uint32_t Count{};
+        };
+
+        explicit GeometryRanges(uint32_t pageElementCount);
+
+        uint32_t GetPageElementCount() const
+        {
+            return m_pageElementCount;
+        }
+
+        size_t GetPageCount() const
+        {
+            return m_pages.size();
+        }
+
+        /// Allocates count elements in frame frameIndex, or returns nothing when count is zero, when it is larger
+        /// than a page or when no page has room for it.
+        std::optional<Range> Allocate(uint32_t count, uint32_t frameIndex);
+
+        /// Adds an empty page and returns its number. Throws when there are MaxPageCount pages already.
+        uint16_t AddPage();
+
+        /// Frees range in frame frameIndex.
+        void Free(const Range& range, uint32_t frameIndex);
+
+        /// Removes every page and pending free.
+        void Clear();
+
+        /// Free ranges of page, as a map from their first element to their element count.
+        const std::map<uint32_t, uint32_t>& GetFreeRanges(uint16_t page) const
+        {
+            return m_pages[page];
+        }
+
+    private:
+        struct PendingFree
+        {
+            Range Freed{};
+            uint32_t FrameIndex{};
+        };
+
+        void ReclaimPendingFrees(uint32_t frameIndex);
+        void AddFreeRange(uint16_t page, uint32_t start, uint32_t count);
+
+        const uint32_t m_pageElementCount;
+        std::vector<std::map<uint32_t, uint32_t>> m_pages{};
+        std::vector<PendingFree> m_pendingFrees{};
+    };
+}
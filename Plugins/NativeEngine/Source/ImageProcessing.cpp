@@ -0,0 +1,409 @@
+#include "ImageProcessing.h"
+
+#include <bx/math.h>
+#include <bx/simd_t.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace Babylon::ImageProcessing
+{
+    namespace
+    {
+        // Large enough for the swaps to run as wide copies, small enough to live on the stack.
+        constexpr size_t SwapChunkSize{256};
+
+        // Resolution of the table from linear intensities back to 8-bit sRGB.
+        constexpr size_t LinearToSrgbSize{4096};
+
+        void SwapRows(uint8_t* first, uint8_t* second, size_t size)
+        {
+            uint8_t chunk[SwapChunkSize];
+            for (size_t offset = 0; offset < size; offset += SwapChunkSize)
+            {
+                const size_t chunkSize = std::min(SwapChunkSize, size - offset);
+                std::memcpy(chunk, first + offset, chunkSize);
+                std::memcpy(first + offset, second + offset, chunkSize);
+                std::memcpy(second + offset, chunk, chunkSize);
+            }
+        }
+
+        // BC1 color block: two 16-bit endpoints, then one byte of 2-bit indices per row of pixels.
+        void FlipColorBlock(uint8_t* block, uint32_t rowCount)
+        {
+            std::reverse(block + 4, block + 4 + rowCount);
+        }
+
+        // BC2 alpha block: one 16-bit row of 4-bit alphas per row of pixels.
+        void FlipExplicitAlphaBlock(uint8_t* block, uint32_t rowCount)
+        {
+            for (uint32_t row = 0; row < rowCount / 2; ++row)
+            {
+                std::swap_ranges(block + row * 2, block + row * 2 + 2, block + (rowCount - row - 1) * 2);
+            }
+        }
+
+        // BC3 alpha and BC4 and BC5 channel block: two 8-bit endpoints, then 48 bits of 3-bit indices, 12 bits per row.
+        void FlipInterpolatedAlphaBlock(uint8_t* block, uint32_t rowCount)
+        {
+            uint64_t indices{};
+            std::memcpy(&indices, block + 2, 6);
+
+            std::array<uint64_t, 4> rows{};
+            for (uint32_t row = 0; row < rows.size(); ++row)
+            {
+                rows[row] = (indices >> (row * 12)) & 0xfff;
+            }
+            std::reverse(rows.begin(), rows.begin() + rowCount);
+
+            indices = 0;
+            for (uint32_t row = 0; row < rows.size(); ++row)
+            {
+                indices |= rows[row] << (row * 12);
+            }
+            std::memcpy(block + 2, &indices, 6);
+        }
+
+        bool CanFlipWithinBlocks(bimg::TextureFormat::Enum format)
+        {
+            switch (format)
+            {
+                case bimg::TextureFormat::BC1:
+                case bimg::TextureFormat::BC2:
+                case bimg::TextureFormat::BC3:
+                case bimg::TextureFormat::BC4:
+                case bimg::TextureFormat::BC5:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // Flips the first rowCount rows of pixels of every block, which are all the rows a block holds except for
+        // images shorter than a block.
+        void FlipWithinBlocks(bimg::TextureFormat::Enum format, uint8_t* blocks, uint32_t size, uint32_t blockSize, uint32_t rowCount)
+        {
+            for (uint8_t* block = blocks; block < blocks + size; block += blockSize)
+            {
+                switch (format)
+                {
+                    case bimg::TextureFormat::BC1:
+                        FlipColorBlock(block, rowCount);
+                        break;
+                    case bimg::TextureFormat::BC2:
+                        FlipExplicitAlphaBlock(block, rowCount);
+                        FlipColorBlock(block + 8, rowCount);
+                        break;
+                    case bimg::TextureFormat::BC3:
+                        FlipInterpolatedAlphaBlock(block, rowCount);
+                        FlipColorBlock(block + 8, rowCount);
+                        break;
+                    case bimg::TextureFormat::BC4:
+                        FlipInterpolatedAlphaBlock(block, rowCount);
+                        break;
+                    case bimg::TextureFormat::BC5:
+                        FlipInterpolatedAlphaBlock(block, rowCount);
+                        FlipInterpolatedAlphaBlock(block + 8, rowCount);
+                        break;
+                    default:
+                        assert(!"Format cannot be flipped within blocks");
+                        break;
+                }
+            }
+        }
+
+        const std::array<float, 256>& SrgbToLinear()
+        {
+            static const std::array<float, 256> table{[]() {
+                std::array<float, 256> result{};
+                for (size_t index = 0; index < result.size(); ++index)
+                {
+                    const float value = static_cast<float>(index) / 255.0f;
+                    result[index] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+                }
+                return result;
+            }()};
+            return table;
+        }
+
+        const std::array<uint8_t, LinearToSrgbSize>& LinearToSrgb()
+        {
+            static const std::array<uint8_t, LinearToSrgbSize> table{[]() {
+                std::array<uint8_t, LinearToSrgbSize> result{};
+                for (size_t index = 0; index < result.size(); ++index)
+                {
+                    const float value = static_cast<float>(index) / static_cast<float>(LinearToSrgbSize - 1);
+                    const float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+                    result[index] = static_cast<uint8_t>(srgb * 255.0f + 0.5f);
+                }
+                return result;
+            }()};
+            return table;
+        }
+
+        // Averages the four RGBA8 pixels packed in a, b, c and d, two channels at a time in 16-bit lanes.
+        uint32_t Average4(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+        {
+            constexpr uint32_t mask{0x00ff00ff};
+            constexpr uint32_t rounding{0x00020002};
+            const uint32_t even = (a & mask) + (b & mask) + (c & mask) + (d & mask) + rounding;
+            const uint32_t odd = ((a >> 8) & mask) + ((b >> 8) & mask) + ((c >> 8) & mask) + ((d >> 8) & mask) + rounding;
+            return ((even >> 2) & mask) | (((odd >> 2) & mask) << 8);
+        }
+
+        // Calls average(destination pixel, the four source pixels) for every pixel of a mip half the size of the
+        // source, repeating the last row and column of sources with odd sizes.
+        template<size_t PixelSize, typename AverageT>
+        void Downsample(const bimg::ImageMip& source, const bimg::ImageMip& destination, const AverageT& average)
+        {
+            const size_t sourcePitch = source.m_width * PixelSize;
+            for (uint32_t y = 0; y < destination.m_height; ++y)
+            {
+                const uint8_t* row0 = source.m_data + std::min(2 * y, source.m_height - 1) * sourcePitch;
+                const uint8_t* row1 = source.m_data + std::min(2 * y + 1, source.m_height - 1) * sourcePitch;
+                uint8_t* output = const_cast<uint8_t*>(destination.m_data) + y * destination.m_width * PixelSize;
+                for (uint32_t x = 0; x < destination.m_width; ++x, output += PixelSize)
+                {
+                    const size_t x0 = std::min(2 * x, source.m_width - 1) * PixelSize;
+                    const size_t x1 = std::min(2 * x + 1, source.m_width - 1) * PixelSize;
+                    average(output, row0 + x0, row0 + x1, row1 + x0, row1 + x1);
+                }
+            }
+        }
+
+        template<size_t ChannelCount>
+        void DownsampleUnorm8(const bimg::ImageMip& source, const bimg::ImageMip& destination, bool srgb)
+        {
+            if constexpr (ChannelCount == 4)
+            {
+                if (!srgb)
+                {
+                    Downsample<4>(source, destination, [](uint8_t* output, const uint8_t* a, const uint8_t* b, const uint8_t* c, const uint8_t* d) {
+                        uint32_t pixels[4];
+                        std::memcpy(&pixels[0], a, 4);
+                        std::memcpy(&pixels[1], b, 4);
+                        std::memcpy(&pixels[2], c, 4);
+                        std::memcpy(&pixels[3], d, 4);
+                        const uint32_t result = Average4(pixels[0], pixels[1], pixels[2], pixels[3]);
+                        std::memcpy(output, &result, 4);
+                    });
+                    return;
+                }
+            }
+
+            // Alpha, and the channels of one and two channel formats, are never sRGB encoded.
+            const bool encoded{srgb && ChannelCount >= 3};
+            const auto& toLinear = SrgbToLinear();
+            const auto& toSrgb = LinearToSrgb();
+            Downsample<ChannelCount>(source, destination, [encoded, &toLinear, &toSrgb](uint8_t* output, const uint8_t* a, const uint8_t* b, const uint8_t* c, const uint8_t* d) {
+                for (size_t channel = 0; channel < ChannelCount; ++channel)
+                {
+                    if (encoded && channel < 3)
+                    {
+                        const float linear = (toLinear[a[channel]] + toLinear[b[channel]] + toLinear[c[channel]] + toLinear[d[channel]]) * 0.25f;
+                        output[channel] = toSrgb[static_cast<size_t>(linear * (LinearToSrgbSize - 1) + 0.5f)];
+                    }
+                    else
+                    {
+                        output[channel] = static_cast<uint8_t>((a[channel] + b[channel] + c[channel] + d[channel] + 2) / 4);
+                    }
+                }
+            });
+        }
+
+        void DownsampleRgba32F(const bimg::ImageMip& source, const bimg::ImageMip& destination)
+        {
+            Downsample<16>(source, destination, [](uint8_t* output, const uint8_t* a, const uint8_t* b, const uint8_t* c, const uint8_t* d) {
+                // Mips are only 4-byte aligned; the copies compile to unaligned loads and stores.
+                alignas(16) float values[4][4];
+                std::memcpy(values[0], a, 16);
+                std::memcpy(values[1], b, 16);
+                std::memcpy(values[2], c, 16);
+                std::memcpy(values[3], d, 16);
+                const bx::simd128_t sum = bx::simd_add(bx::simd_add(bx::simd_ld(values[0]), bx::simd_ld(values[1])), bx::simd_add(bx::simd_ld(values[2]), bx::simd_ld(values[3])));
+                bx::simd_st(values[0], bx::simd_mul(sum, bx::simd_splat(0.25f)));
+                std::memcpy(output, values[0], 16);
+            });
+        }
+
+        void DownsampleRgba16F(const bimg::ImageMip& source, const bimg::ImageMip& destination)
+        {
+            Downsample<8>(source, destination, [](uint8_t* output, const uint8_t* a, const uint8_t* b, const uint8_t* c, const uint8_t* d) {
+                uint16_t halves[4][4];
+                std::memcpy(halves[0], a, 8);
+                std::memcpy(halves[1], b, 8);
+                std::memcpy(halves[2], c, 8);
+                std::memcpy(halves[3], d, 8);
+                uint16_t result[4];
+                for (size_t channel = 0; channel < 4; ++channel)
+                {
+                    const float sum = bx::halfToFloat(halves[0][channel]) + bx::halfToFloat(halves[1][channel]) + bx::halfToFloat(halves[2][channel]) + bx::halfToFloat(halves[3][channel]);
+                    result[channel] = bx::halfFromFloat(sum * 0.25f);
+                }
+                std::memcpy(output, result, 8);
+            });
+        }
+
+        void DownsampleMip(bimg::TextureFormat::Enum format, const bimg::ImageMip& source, const bimg::ImageMip& destination, bool srgb)
+        {
+            switch (format)
+            {
+                case bimg::TextureFormat::R8:
+                    DownsampleUnorm8<1>(source, destination, srgb);
+                    break;
+                case bimg::TextureFormat::RG8:
+                    DownsampleUnorm8<2>(source, destination, srgb);
+                    break;
+                case bimg::TextureFormat::RGB8:
+                    DownsampleUnorm8<3>(source, destination, srgb);
+                    break;
+                case bimg::TextureFormat::RGBA8:
+                case bimg::TextureFormat::BGRA8:
+                    DownsampleUnorm8<4>(source, destination, srgb);
+                    break;
+                case bimg::TextureFormat::RGBA16F:
+                    DownsampleRgba16F(source, destination);
+                    break;
+                case bimg::TextureFormat::RGBA32F:
+                    DownsampleRgba32F(source, destination);
+                    break;
+                default:
+                    throw std::runtime_error{"Unsupported format for mip generation"};
+            }
+        }
+
+        bool HasOwnFilter(bimg::TextureFormat::Enum format)
+        {
+            switch (format)
+            {
+                case bimg::TextureFormat::R8:
+                case bimg::TextureFormat::RG8:
+                case bimg::TextureFormat::RGB8:
+                case bimg::TextureFormat::RGBA8:
+                case bimg::TextureFormat::BGRA8:
+                case bimg::TextureFormat::RGBA16F:
+                case bimg::TextureFormat::RGBA32F:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        bimg::ImageMip GetMip(const bimg::ImageContainer& image, uint16_t side, uint8_t mip)
+        {
+            bimg::ImageMip imageMip{};
+            bimg::imageGetRawData(image, side, mip, image.m_data, image.m_size, imageMip);
+            return imageMip;
+        }
+
+        // The previous path, for formats bimg can only mip as RGBA8.
+        void GenerateMipsThroughBimg(bx::AllocatorI* allocator, bimg::ImageContainer** image)
+        {
+            bimg::ImageContainer* input = *image;
+            const bool srgb = input->m_srgb;
+
+            bimg::ImageContainer* output = bimg::imageGenerateMips(allocator, *input);
+            if (output == nullptr)
+            {
+                bimg::TextureFormat::Enum format = input->m_format;
+                bimg::ImageContainer* rgba = bimg::imageConvert(allocator, bimg::TextureFormat::RGBA8, *input, false);
+                bimg::imageFree(input);
+                bimg::ImageContainer* mips = bimg::imageGenerateMips(allocator, *rgba);
+                bimg::imageFree(rgba);
+                output = bimg::imageConvert(allocator, format, *mips);
+                bimg::imageFree(mips);
+            }
+            else
+            {
+                bimg::imageFree(input);
+            }
+
+            output->m_srgb = srgb;
+            *image = output;
+        }
+    }
+
+    void FlipY(bimg::ImageContainer& image)
+    {
+        const bimg::ImageBlockInfo& blockInfo = bimg::getBlockInfo(image.m_format);
+        const uint32_t blockHeight = blockInfo.blockHeight;
+        const bool compressed = bimg::isCompressed(image.m_format);
+
+        // Checked before anything is flipped, so that a failure leaves the image as it was.
+        if (compressed)
+        {
+            if (!CanFlipWithinBlocks(image.m_format))
+            {
+                throw std::runtime_error{"Compressed format cannot be flipped"};
+            }
+
+            // Rows of pixels cannot move between blocks, so a block row that is only partly used can only be
+            // flipped when it is the only one.
+            for (uint8_t mip = 0; mip < image.m_numMips; ++mip)
+            {
+                const uint32_t height = GetMip(image, 0, mip).m_height;
+                if (height > blockHeight && height % blockHeight != 0)
+                {
+                    throw std::runtime_error{"Compressed image height is not a multiple of its block height"};
+                }
+            }
+        }
+
+        const uint16_t sideCount = static_cast<uint16_t>(image.m_numLayers * (image.m_cubeMap ? 6 : 1));
+        for (uint16_t side = 0; side < sideCount; ++side)
+        {
+            for (uint8_t mip = 0; mip < image.m_numMips; ++mip)
+            {
+                const bimg::ImageMip imageMip = GetMip(image, side, mip);
+                const uint32_t rowCount = std::max((imageMip.m_height + blockHeight - 1) / blockHeight, 1u);
+                const uint32_t rowPitch = imageMip.m_size / rowCount;
+
+                uint8_t* bytes = const_cast<uint8_t*>(imageMip.m_data);
+                for (uint32_t row = 0; row < rowCount / 2; ++row)
+                {
+                    SwapRows(bytes + row * rowPitch, bytes + (rowCount - row - 1) * rowPitch, rowPitch);
+                }
+
+                if (compressed)
+                {
+                    FlipWithinBlocks(image.m_format, bytes, imageMip.m_size, blockInfo.blockSize, std::min(imageMip.m_height, blockHeight));
+                }
+            }
+        }
+    }
+
+    void GenerateMips(bx::AllocatorI* allocator, bimg::ImageContainer** image, bool srgb)
+    {
+        const bimg::ImageContainer& input = **image;
+        srgb = srgb || input.m_srgb;
+        if (!HasOwnFilter(input.m_format) || input.m_cubeMap || input.m_depth != 1)
+        {
+            GenerateMipsThroughBimg(allocator, image);
+            return;
+        }
+
+        // All mips are written into the one new image, which is uploaded without further copies.
+        bimg::ImageContainer* output = bimg::imageAlloc(allocator, input.m_format, static_cast<uint16_t>(input.m_width), static_cast<uint16_t>(input.m_height), 1, input.m_numLayers, false, true);
+        output->m_srgb = input.m_srgb;
+        for (uint16_t layer = 0; layer < input.m_numLayers; ++layer)
+        {
+            const bimg::ImageMip top = GetMip(input, layer, 0);
+            bimg::ImageMip previous = GetMip(*output, layer, 0);
+            std::memcpy(const_cast<uint8_t*>(previous.m_data), top.m_data, top.m_size);
+
+            for (uint8_t mip = 1; mip < output->m_numMips; ++mip)
+            {
+                const bimg::ImageMip next = GetMip(*output, layer, mip);
+                DownsampleMip(input.m_format, previous, next, srgb);
+                previous = next;
+            }
+        }
+
+        bimg::imageFree(*image);
+        *image = output;
+    }
+}
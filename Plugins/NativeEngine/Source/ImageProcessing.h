@@ -0,0 +1,23 @@
+#pragma once
+
+#include <bimg/bimg.h>
+#include <bx/allocator.h>
+
+namespace Babylon
+{
+    /// Preparation of decoded images for upload, done in place or into a single new image rather than through
+    /// bimg's format conversions.
+    namespace ImageProcessing
+    {
+        /// Flips every mip of every face and layer of image upside down, in place. BC1 to BC5 are flipped by rows of
+        /// blocks and then within each block. Throws for other compressed formats, and for compressed mips whose
+        /// height is neither a multiple of the block height nor less than it.
+        void FlipY(bimg::ImageContainer& image);
+
+        /// Replaces image with a copy that has a complete mip chain, built with a 2x2 box filter. 8-bit formats of
+        /// three or four channels are filtered in linear space when srgb or the image's m_srgb is set, and m_srgb
+        /// is kept on the copy; 16- and 32-bit float formats stay in floating point. Formats other than 8-bit
+        /// unorm, RGBA16F and RGBA32F go through bimg, by way of RGBA8.
+        void GenerateMips(bx::AllocatorI* allocator, bimg::ImageContainer** image, bool srgb = false);
+    }
+}
@@ -0,0 +1,222 @@
+#include "Ktx2.h"
+
+#include <bgfx/bgfx.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace Babylon::Ktx2
+{
+    namespace
+    {
+        constexpr std::array<uint8_t, 12> Identifier{0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+        // The identifier, nine 32-bit header fields and the index of the data format descriptor, key/value data and
+        // supercompression global data, after which comes one level index entry per mip.
+        constexpr size_t HeaderSize{Identifier.size() + 9 * sizeof(uint32_t)};
+        constexpr size_t LevelIndexOffset{HeaderSize + 4 * sizeof(uint32_t) + 2 * sizeof(uint64_t)};
+        constexpr size_t LevelIndexEntrySize{3 * sizeof(uint64_t)};
+
+        constexpr uint32_t SupercompressionNone{0};
+
+        struct Header
+        {
+            uint32_t VkFormat{};
+            uint32_t TypeSize{};
+            uint32_t PixelWidth{};
+            uint32_t PixelHeight{};
+            uint32_t PixelDepth{};
+            uint32_t LayerCount{};
+            uint32_t FaceCount{};
+            uint32_t LevelCount{};
+            uint32_t SupercompressionScheme{};
+        };
+
+        struct Level
+        {
+            uint64_t ByteOffset{};
+            uint64_t ByteLength{};
+            uint64_t UncompressedByteLength{};
+        };
+
+        template<typename T>
+        T Read(gsl::span<const uint8_t> data, size_t offset)
+        {
+            if (offset + sizeof(T) > static_cast<size_t>(data.size()))
+            {
+                throw std::runtime_error{"KTX2 file is truncated"};
+            }
+
+            // KTX2 is little endian, like every platform bgfx supports.
+            T value;
+            std::memcpy(&value, data.data() + offset, sizeof(T));
+            return value;
+        }
+
+        struct FormatMapping
+        {
+            uint32_t VkFormat;
+            bimg::TextureFormat::Enum Format;
+            bool Srgb;
+        };
+
+        // VkFormat values. bgfx has no sRGB formats of its own; sRGB variants share the linear format and are
+        // sampled as sRGB through BGFX_TEXTURE_SRGB.
+        constexpr FormatMapping FormatMappings[]{
+            {9, bimg::TextureFormat::R8, false},
+            {16, bimg::TextureFormat::RG8, false},
+            {23, bimg::TextureFormat::RGB8, false},
+            {37, bimg::TextureFormat::RGBA8, false},
+            {43, bimg::TextureFormat::RGBA8, true},
+            {44, bimg::TextureFormat::BGRA8, false},
+            {50, bimg::TextureFormat::BGRA8, true},
+            {97, bimg::TextureFormat::RGBA16F, false},
+            {109, bimg::TextureFormat::RGBA32F, false},
+            {131, bimg::TextureFormat::BC1, false},
+            {132, bimg::TextureFormat::BC1, true},
+            {133, bimg::TextureFormat::BC1, false},
+            {134, bimg::TextureFormat::BC1, true},
+            {135, bimg::TextureFormat::BC2, false},
+            {136, bimg::TextureFormat::BC2, true},
+            {137, bimg::TextureFormat::BC3, false},
+            {138, bimg::TextureFormat::BC3, true},
+            {139, bimg::TextureFormat::BC4, false},
+            {141, bimg::TextureFormat::BC5, false},
+            {143, bimg::TextureFormat::BC6H, false},
+            {145, bimg::TextureFormat::BC7, false},
+            {146, bimg::TextureFormat::BC7, true},
+            {147, bimg::TextureFormat::ETC2, false},
+            {148, bimg::TextureFormat::ETC2, true},
+            {149, bimg::TextureFormat::ETC2A1, false},
+            {150, bimg::TextureFormat::ETC2A1, true},
+            {151, bimg::TextureFormat::ETC2A, false},
+            {152, bimg::TextureFormat::ETC2A, true},
+            {157, bimg::TextureFormat::ASTC4x4, false},
+            {158, bimg::TextureFormat::ASTC4x4, true},
+            {161, bimg::TextureFormat::ASTC5x5, false},
+            {162, bimg::TextureFormat::ASTC5x5, true},
+            {165, bimg::TextureFormat::ASTC6x6, false},
+            {166, bimg::TextureFormat::ASTC6x6, true},
+            {167, bimg::TextureFormat::ASTC8x5, false},
+            {168, bimg::TextureFormat::ASTC8x5, true},
+            {169, bimg::TextureFormat::ASTC8x6, false},
+            {170, bimg::TextureFormat::ASTC8x6, true},
+            {173, bimg::TextureFormat::ASTC10x5, false},
+            {174, bimg::TextureFormat::ASTC10x5, true},
+        };
+
+        const FormatMapping* FindFormat(uint32_t vkFormat)
+        {
+            const auto it = std::find_if(std::begin(FormatMappings), std::end(FormatMappings), [vkFormat](const FormatMapping& mapping) {
+                return mapping.VkFormat == vkFormat;
+            });
+            return it == std::end(FormatMappings) ? nullptr : it;
+        }
+
+        uint8_t CompleteMipCount(uint32_t width, uint32_t height)
+        {
+            uint8_t count{1};
+            for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+            {
+                ++count;
+            }
+            return count;
+        }
+
+        bool IsSupported(bimg::TextureFormat::Enum format, bool srgb)
+        {
+            return (bgfx::getCaps()->formats[format] & (srgb ? BGFX_CAPS_FORMAT_TEXTURE_2D_SRGB : BGFX_CAPS_FORMAT_TEXTURE_2D)) != 0;
+        }
+    }
+
+    bool IsKtx2(gsl::span<const uint8_t> data)
+    {
+        return static_cast<size_t>(data.size()) >= Identifier.size() && std::memcmp(data.data(), Identifier.data(), Identifier.size()) == 0;
+    }
+
+    bimg::ImageContainer* Parse(bx::AllocatorI* allocator, gsl::span<const uint8_t> data)
+    {
+        if (!IsKtx2(data))
+        {
+            throw std::runtime_error{"Not a KTX2 file"};
+        }
+
+        Header header{};
+        size_t offset{Identifier.size()};
+        for (uint32_t* field : {&header.VkFormat, &header.TypeSize, &header.PixelWidth, &header.PixelHeight, &header.PixelDepth, &header.LayerCount, &header.FaceCount, &header.LevelCount, &header.SupercompressionScheme})
+        {
+            *field = Read<uint32_t>(data, offset);
+            offset += sizeof(uint32_t);
+        }
+
+        if (header.VkFormat == 0)
+        {
+            throw std::runtime_error{"KTX2 Basis Universal textures are not supported; they are not transcoded"};
+        }
+        if (header.SupercompressionScheme != SupercompressionNone)
+        {
+            throw std::runtime_error{"KTX2 supercompression is not supported"};
+        }
+        if (header.PixelWidth == 0 || header.PixelHeight == 0 || header.PixelDepth > 1 || header.LayerCount > 1 || header.FaceCount != 1)
+        {
+            throw std::runtime_error{"Only 2D KTX2 textures are supported"};
+        }
+        if (header.PixelWidth > UINT16_MAX || header.PixelHeight > UINT16_MAX)
+        {
+            throw std::runtime_error{"KTX2 texture is too large"};
+        }
+
+        const FormatMapping* mapping = FindFormat(header.VkFormat);
+        if (mapping == nullptr)
+        {
+            throw std::runtime_error{"Unsupported KTX2 format"};
+        }
+        const bimg::TextureFormat::Enum format = mapping->Format;
+
+        // A level count of zero asks for mips to be generated, which is left to the caller.
+        const uint32_t levelCount = std::max(header.LevelCount, 1u);
+        const bool hasMips = levelCount > 1 && levelCount == CompleteMipCount(header.PixelWidth, header.PixelHeight);
+
+        bimg::ImageContainer* image = bimg::imageAlloc(allocator, format, static_cast<uint16_t>(header.PixelWidth), static_cast<uint16_t>(header.PixelHeight), 1, 1, false, hasMips);
+        try
+        {
+            for (uint8_t mip = 0; mip < image->m_numMips; ++mip)
+            {
+                const size_t entryOffset = LevelIndexOffset + mip * LevelIndexEntrySize;
+                const Level level{Read<uint64_t>(data, entryOffset), Read<uint64_t>(data, entryOffset + 8), Read<uint64_t>(data, entryOffset + 16)};
+
+                bimg::ImageMip imageMip{};
+                bimg::imageGetRawData(*image, 0, mip, image->m_data, image->m_size, imageMip);
+                if (level.ByteLength != imageMip.m_size || level.ByteLength > static_cast<uint64_t>(data.size()) || level.ByteOffset > static_cast<uint64_t>(data.size()) - level.ByteLength)
+                {
+                    throw std::runtime_error{"KTX2 level does not match its format and size"};
+                }
+
+                std::memcpy(const_cast<uint8_t*>(imageMip.m_data), data.data() + level.ByteOffset, imageMip.m_size);
+            }
+        }
+        catch (...)
+        {
+            bimg::imageFree(image);
+            throw;
+        }
+
+        if (!IsSupported(format, mapping->Srgb))
+        {
+            bimg::ImageContainer* decoded = bimg::imageConvert(allocator, bimg::TextureFormat::RGBA8, *image, true);
+            bimg::imageFree(image);
+            if (decoded == nullptr)
+            {
+                throw std::runtime_error{"KTX2 format is not supported by the GPU and cannot be decoded"};
+            }
+            image = decoded;
+        }
+
+        // Decoding keeps the encoding of the colors, so a decoded sRGB image is still sRGB.
+        image->m_srgb = mapping->Srgb;
+        return image;
+    }
+}
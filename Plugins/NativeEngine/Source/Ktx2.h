@@ -0,0 +1,28 @@
+#pragma once
+
+#include <bimg/bimg.h>
+#include <bx/allocator.h>
+#include <gsl/gsl>
+
+#include <cstdint>
+
+namespace Babylon
+{
+    /// Passthrough loading of KTX2 containers, which bimg does not parse. Payloads stored in a GPU format are kept in
+    /// that format, mips included, so block compressed textures reach the GPU without being expanded to RGBA8.
+    ///
+    /// Only 2D textures without supercompression are supported. Nothing is transcoded: Basis Universal payloads
+    /// (ETC1S and UASTC) would need the basis_universal transcoder and a target format picked from the GPU's caps,
+    /// neither of which is part of this build, so they are rejected like any other unsupported file.
+    namespace Ktx2
+    {
+        /// Returns whether data starts with the KTX2 file identifier.
+        bool IsKtx2(gsl::span<const uint8_t> data);
+
+        /// Parses a KTX2 file into an image with the file's format and mips. The image's m_srgb is set for sRGB
+        /// formats, whose textures must be created with BGFX_TEXTURE_SRGB. A format the GPU cannot sample is
+        /// decoded to RGBA8 when bimg can decode it. Mip chains that are neither complete nor a single level are
+        /// cut down to the base level. Throws when the file is malformed or its format cannot be used.
+        bimg::ImageContainer* Parse(bx::AllocatorI* allocator, gsl::span<const uint8_t> data);
+    }
+}
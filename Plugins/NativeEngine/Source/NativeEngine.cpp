@@ -1,5 +1,12 @@
 #include "NativeEngine.h"
+#include "CommandStream.h"
+#include "FrustumCulling.h"
+#include "ImageProcessing.h"
+#include "Ktx2.h"
+#include "ParallelFor.h"
 #include "ShaderCompiler.h"
+#include "UniformArrays.h"
+#include "WorldMatrices.h"
 #include <arcana/threading/task.h>
 #include <arcana/threading/task_schedulers.h>
 
@@ -15,9 +22,13 @@
 
 #include <bx/math.h>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <queue>
 #include <regex>
 #include <sstream>
+#include <type_traits>
 #include <variant>
 
 namespace Babylon
@@ -69,59 +80,49 @@ namespace Babylon
             return static_cast<bgfx::TextureFormat::Enum>(format);
         }
 
-        void FlipY(bimg::ImageContainer* image)
+        void ReleaseImage(void* /*ptr*/, void* userData)
         {
-            uint8_t* bytes = static_cast<uint8_t*>(image->m_data);
-            uint32_t rowCount = image->m_height;
-            uint32_t rowPitch = image->m_size / image->m_height;
-
-            std::vector<uint8_t> buffer(rowPitch);
+            bimg::imageFree(static_cast<bimg::ImageContainer*>(userData));
+        }
 
-            for (size_t row = 0; row < rowCount / 2; row++)
-            {
-                auto frontPtr = bytes + (row * rowPitch);
-                auto backPtr = bytes + ((rowCount - row - 1) * rowPitch);
+        // Whether bgfx can render to textures of the format and generate their mips on the GPU.
+        bool CanGenerateMipsOnGpu(bgfx::TextureFormat::Enum format)
+        {
+            const auto caps = bgfx::getCaps()->formats[format];
+            return (caps & BGFX_CAPS_FORMAT_TEXTURE_MIP_AUTOGEN) != 0 && (caps & BGFX_CAPS_FORMAT_TEXTURE_FRAMEBUFFER) != 0;
+        }
 
-                std::memcpy(buffer.data(), frontPtr, rowPitch);
-                std::memcpy(frontPtr, backPtr, rowPitch);
-                std::memcpy(backPtr, buffer.data(), rowPitch);
-            }
+        bool CanGenerateMipsOnGpu(const bimg::ImageContainer& image)
+        {
+            return !image.m_cubeMap && image.m_numLayers == 1 && image.m_depth == 1 && CanGenerateMipsOnGpu(Cast(image.m_format));
         }
 
-        void GenerateMips(bx::AllocatorI* allocator, bimg::ImageContainer** image)
+        // Images stored in an sRGB format are sampled as sRGB, so that filtering happens on linear colors.
+        uint64_t TextureFlags(const bimg::ImageContainer& image)
         {
-            bimg::ImageContainer* input = *image;
+            return (image.m_srgb ? BGFX_TEXTURE_SRGB : BGFX_TEXTURE_NONE) | BGFX_SAMPLER_NONE;
+        }
 
-            bimg::ImageContainer* output = bimg::imageGenerateMips(allocator, *input);
-            if (output == nullptr)
-            {
-                bimg::TextureFormat::Enum format = input->m_format;
-                bimg::ImageContainer* rgba = bimg::imageConvert(allocator, bimg::TextureFormat::RGBA8, *input, false);
-                bimg::imageFree(input);
-                bimg::ImageContainer* mips = bimg::imageGenerateMips(allocator, *rgba);
-                bimg::imageFree(rgba);
-                output = bimg::imageConvert(allocator, format, *mips);
-                bimg::imageFree(mips);
-            }
-            else
+        bimg::ImageContainer* ParseImage(bx::AllocatorI* allocator, gsl::span<const uint8_t> data)
+        {
+            bimg::ImageContainer* image = Ktx2::IsKtx2(data)
+                ? Ktx2::Parse(allocator, data)
+                : bimg::imageParse(allocator, data.data(), static_cast<uint32_t>(data.size()));
+            if (image == nullptr)
             {
-                bimg::imageFree(input);
+                throw std::runtime_error("Unable to decode image."); // exeption will be forwarded to JS
             }
-
-            *image = output;
+            return image;
         }
 
         void CreateTextureFromImage(TextureData* texture, bimg::ImageContainer* image)
         {
-            auto releaseFn = [](void* /*ptr*/, void* userData) {
-                bimg::imageFree(static_cast<bimg::ImageContainer*>(userData));
-            };
+            auto mem = bgfx::makeRef(image->m_data, image->m_size, ReleaseImage, image);
 
-            auto mem = bgfx::makeRef(image->m_data, image->m_size, releaseFn, image);
-
-            texture->Handle = bgfx::createTexture2D(static_cast<uint16_t>(image->m_width), static_cast<uint16_t>(image->m_height), (image->m_numMips > 1), 1, Cast(image->m_format), BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE, mem);
+            texture->Handle = bgfx::createTexture2D(static_cast<uint16_t>(image->m_width), static_cast<uint16_t>(image->m_height), (image->m_numMips > 1), 1, Cast(image->m_format), TextureFlags(*image), mem);
             texture->Width = image->m_width;
             texture->Height = image->m_height;
+            texture->Tracked.Track(ResourceType::Texture, image->m_size);
         }
 
         void CreateCubeTextureFromImages(TextureData* texture, const std::vector<bimg::ImageContainer*>& images, bool hasMips)
@@ -130,6 +131,7 @@ namespace Babylon
             uint32_t width = firstImage->m_width;
             uint32_t height = firstImage->m_height;
             bgfx::TextureFormat::Enum format = Cast(firstImage->m_format);
+            const uint64_t flags = TextureFlags(*firstImage);
 
             uint32_t totalSize = 0;
             for (auto image : images)
@@ -147,9 +149,92 @@ namespace Babylon
                 bimg::imageFree(image);
             }
 
-            texture->Handle = bgfx::createTextureCube(static_cast<uint16_t>(width), hasMips, 1, format, BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE, mem);
+            texture->Handle = bgfx::createTextureCube(static_cast<uint16_t>(width), hasMips, 1, format, flags, mem);
             texture->Width = width;
             texture->Height = height;
+            texture->Tracked.Track(ResourceType::Texture, totalSize);
+        }
+
+        uint32_t HashTextureBinding(uint8_t stage, uint16_t uniform, uint16_t texture, uint32_t flags)
+        {
+            // MurmurHash3 finalizer, so that XOR-ing the hashes of several bindings keeps them distinguishable.
+            uint32_t hash = (static_cast<uint32_t>(stage) << 24) ^ (static_cast<uint32_t>(uniform) << 16) ^ texture ^ (flags * 0x9e3779b9u);
+            hash ^= hash >> 16;
+            hash *= 0x85ebca6bu;
+            hash ^= hash >> 13;
+            hash *= 0xc2b2ae35u;
+            hash ^= hash >> 16;
+            return hash;
+        }
+
+        uint32_t CountChanges(const std::vector<uint64_t>& draws, uint64_t mask)
+        {
+            uint32_t changes{0};
+            for (size_t index = 1; index < draws.size(); ++index)
+            {
+                if ((draws[index] & mask) != (draws[index - 1] & mask))
+                {
+                    ++changes;
+                }
+            }
+            return changes;
+        }
+
+        // Size of a 2D texture with all of its mips, as bgfx allocates it.
+        uint64_t TextureBytes(uint16_t width, uint16_t height, bool hasMips, bgfx::TextureFormat::Enum format)
+        {
+            bgfx::TextureInfo textureInfo{};
+            bgfx::calcTextureSize(textureInfo, width, height, 1, false, hasMips, 1, format);
+            return textureInfo.storageSize;
+        }
+
+        // A JavaScript array whose bytes bgfx references, kept alive until bgfx releases them.
+        struct JsArrayReference
+        {
+            JsRuntime& Runtime;
+            Napi::Reference<Napi::TypedArray> Array;
+        };
+
+        // Wraps a range of a JavaScript typed array as bgfx memory without copying it. bgfx can release the memory on
+        // the render thread, so the reference to the array is released on the JavaScript thread.
+        const bgfx::Memory* MakeJsArrayRef(JsRuntime& runtime, const Napi::TypedArray& array, const uint8_t* data, uint32_t byteLength)
+        {
+            auto* reference = new JsArrayReference{runtime, Napi::Persistent(array)};
+            return bgfx::makeRef(
+                data, byteLength, [](void*, void* userData) {
+                    auto* reference = static_cast<JsArrayReference*>(userData);
+                    reference->Runtime.Dispatch([reference](Napi::Env) {
+                        delete reference;
+                    });
+                },
+                reference);
+        }
+
+        void InitUniformInfos(bgfx::ShaderHandle shader, const std::unordered_map<std::string, uint8_t>& uniformStages, std::unordered_map<std::string, UniformInfo>& uniformInfos, ProgramData& programData)
+        {
+            auto numUniforms = bgfx::getShaderUniforms(shader);
+            std::vector<bgfx::UniformHandle> uniforms{numUniforms};
+            bgfx::getShaderUniforms(shader, uniforms.data(), gsl::narrow_cast<uint16_t>(uniforms.size()));
+
+            for (uint8_t index = 0; index < numUniforms; index++)
+            {
+                bgfx::UniformInfo info{};
+                bgfx::getUniformInfo(uniforms[index], info);
+                auto itStage = uniformStages.find(info.name);
+                uniformInfos[info.name] = {itStage == uniformStages.end() ? uint8_t{} : itStage->second, uniforms[index]};
+                bool YFlip{false};
+                if (!bgfx::getCaps()->originBottomLeft)
+                {
+                    YFlip = (!strcmp(info.name, "projection")) || (!strcmp(info.name, "viewProjection"));
+                }
+                uniformInfos[info.name].YFlip = YFlip;
+
+                if (info.type != bgfx::UniformType::Sampler)
+                {
+                    // Uniforms shared by the vertex and fragment shaders have the same handle and share a slot.
+                    uniformInfos[info.name].Slot = programData.AddUniform(uniforms[index], info.type, info.num, YFlip);
+                }
+            }
         }
     }
 
@@ -176,21 +261,61 @@ namespace Babylon
     class IndexBufferData final : private VariantHandleHolder<bgfx::IndexBufferHandle, bgfx::DynamicIndexBufferHandle>
     {
     public:
-        IndexBufferData(const Napi::TypedArray& bytes, uint16_t flags, bool dynamic)
+        /// Static buffers are sub-allocated from heap when one is given and the indices fit in one of its pages.
+        IndexBufferData(const Napi::TypedArray& bytes, uint16_t flags, bool dynamic, JsRuntime& runtime, std::shared_ptr<GeometryHeap> heap, bool transient = false)
         {
-            const bgfx::Memory* memory = bgfx::copy(bytes.As<Napi::Uint8Array>().Data(), static_cast<uint32_t>(bytes.ByteLength()));
+            if (transient)
+            {
+                if ((flags & BGFX_BUFFER_INDEX32) != 0)
+                {
+                    throw std::runtime_error{"Transient index buffers only support 16-bit indices."};
+                }
+
+                m_handle = bgfx::DynamicIndexBufferHandle{bgfx::kInvalidHandle};
+                m_transient = std::make_unique<TransientState>();
+                m_transient->Source = Napi::Persistent(bytes);
+                return;
+            }
+
+            const uint8_t* data = bytes.As<Napi::Uint8Array>().Data();
+            const auto byteLength = static_cast<uint32_t>(bytes.ByteLength());
             if (!dynamic)
             {
-                m_handle = bgfx::createIndexBuffer(memory, flags);
+                // Static buffers are never written to again, so bgfx can read the JavaScript array directly.
+                m_handle = bgfx::IndexBufferHandle{bgfx::kInvalidHandle};
+                const uint32_t indexSize = (flags & BGFX_BUFFER_INDEX32) != 0 ? 4 : 2;
+                if (auto allocation = heap ? heap->Allocate(byteLength / indexSize) : std::nullopt)
+                {
+                    heap->Update(*allocation, MakeJsArrayRef(runtime, bytes, data, byteLength));
+                    m_heap = std::move(heap);
+                    m_allocation = *allocation;
+                }
+                else
+                {
+                    m_handle = bgfx::createIndexBuffer(MakeJsArrayRef(runtime, bytes, data, byteLength), flags);
+                }
             }
             else
             {
-                m_handle = bgfx::createDynamicIndexBuffer(memory, flags);
+                m_handle = bgfx::createDynamicIndexBuffer(bgfx::copy(data, byteLength), flags | BGFX_BUFFER_ALLOW_RESIZE);
             }
+
+            m_tracked.Track(ResourceType::IndexBuffer, byteLength);
         }
 
         ~IndexBufferData()
         {
+            if (m_transient)
+            {
+                return;
+            }
+
+            if (m_heap)
+            {
+                m_heap->Free(m_allocation);
+                return;
+            }
+
             constexpr auto nonDynamic = [](auto handle) {
                 bgfx::destroy(handle);
             };
@@ -200,49 +325,129 @@ namespace Babylon
             DoForHandleTypes(nonDynamic, dynamic);
         }
 
-        void Update(const Napi::TypedArray& bytes, uint32_t startingIdx)
+        /// Writes the indices of bytes starting at index startingIdx. With zeroCopy, bgfx reads the JavaScript array
+        /// directly when it processes the update, so the array must not change until the frame has been rendered.
+        void Update(const Napi::TypedArray& bytes, uint32_t startingIdx, bool zeroCopy, JsRuntime& runtime)
         {
-            const bgfx::Memory* memory = bgfx::copy(bytes.As<Napi::Uint8Array>().Data(), static_cast<uint32_t>(bytes.ByteLength()));
+            if (m_transient)
+            {
+                if (startingIdx != 0)
+                {
+                    throw std::runtime_error{"Transient index buffers can only be replaced as a whole."};
+                }
+
+                m_transient->Source = Napi::Persistent(bytes);
+                m_transient->FrameIndex = TransientState::kNoFrame;
+                return;
+            }
 
             constexpr auto nonDynamic = [](auto) {
                 throw std::runtime_error("Cannot update a non-dynamic index buffer.");
             };
-            const auto dynamic = [memory, startingIdx](auto handle) {
-                bgfx::update(handle, startingIdx, memory);
+            const auto dynamic = [&bytes, startingIdx, zeroCopy, &runtime, this](auto handle) {
+                const uint8_t* data = bytes.As<Napi::Uint8Array>().Data();
+                const auto byteLength = static_cast<uint32_t>(bytes.ByteLength());
+                bgfx::update(handle, startingIdx, zeroCopy ? MakeJsArrayRef(runtime, bytes, data, byteLength) : bgfx::copy(data, byteLength));
+
+                const uint64_t indexSize = bytes.TypedArrayType() == napi_typedarray_type::napi_uint16_array ? 2 : 4;
+                m_tracked.Track(ResourceType::IndexBuffer, std::max<uint64_t>(m_tracked.GetBytes(), startingIdx * indexSize + byteLength));
             };
             DoForHandleTypes(nonDynamic, dynamic);
         }
 
-        void SetBgfxIndexBuffer(uint32_t firstIndex, uint32_t numIndices) const
+        void SetBgfxIndexBuffer(bgfx::Encoder* encoder, uint32_t firstIndex, uint32_t numIndices, uint32_t frameIndex) const
         {
-            const auto nonDynamic = [firstIndex, numIndices](auto handle) {
-                bgfx::setIndexBuffer(handle, firstIndex, numIndices);
+            if (m_transient)
+            {
+                // The indices are copied once per frame, into memory bgfx recycles when the frame ends.
+                if (m_transient->FrameIndex != frameIndex)
+                {
+                    const Napi::TypedArray source = m_transient->Source.Value();
+                    const auto count = static_cast<uint32_t>(source.ByteLength() / sizeof(uint16_t));
+                    if (bgfx::getAvailTransientIndexBuffer(count) < count)
+                    {
+                        throw std::runtime_error{"Out of transient index buffer memory for this frame."};
+                    }
+
+                    bgfx::allocTransientIndexBuffer(&m_transient->Buffer, count);
+                    std::memcpy(m_transient->Buffer.data, source.As<Napi::Uint8Array>().Data(), count * sizeof(uint16_t));
+                    m_transient->FrameIndex = frameIndex;
+                }
+
+                encoder->setIndexBuffer(&m_transient->Buffer, firstIndex, numIndices);
+                return;
+            }
+
+            if (m_heap)
+            {
+                encoder->setIndexBuffer(bgfx::DynamicIndexBufferHandle{m_allocation.Handle}, m_allocation.Start + firstIndex, numIndices);
+                return;
+            }
+
+            const auto nonDynamic = [encoder, firstIndex, numIndices](auto handle) {
+                encoder->setIndexBuffer(handle, firstIndex, numIndices);
             };
-            const auto dynamic = [firstIndex, numIndices](auto handle) {
-                bgfx::setIndexBuffer(handle, firstIndex, numIndices);
+            const auto dynamic = [encoder, firstIndex, numIndices](auto handle) {
+                encoder->setIndexBuffer(handle, firstIndex, numIndices);
             };
             DoForHandleTypes(nonDynamic, dynamic);
         }
+
+    private:
+        // Transient buffers reference the JavaScript data instead of owning a bgfx buffer, and copy it into a
+        // bgfx transient buffer the first time they are bound in a frame.
+        struct TransientState
+        {
+            static constexpr uint32_t kNoFrame{std::numeric_limits<uint32_t>::max()};
+
+            Napi::Reference<Napi::TypedArray> Source{};
+            bgfx::TransientIndexBuffer Buffer{};
+            uint32_t FrameIndex{kNoFrame};
+        };
+
+        std::unique_ptr<TransientState> m_transient{};
+        std::shared_ptr<GeometryHeap> m_heap{};
+        GeometryHeap::Allocation m_allocation{};
+        TrackedResource m_tracked{};
     };
 
     class VertexBufferData final : VariantHandleHolder<bgfx::VertexBufferHandle, bgfx::DynamicVertexBufferHandle>
     {
     public:
-        VertexBufferData(const Napi::Uint8Array& bytes, bool dynamic)
-            : m_bytes{bytes.Data(), bytes.Data() + bytes.ByteLength()}
+        VertexBufferData(const Napi::Uint8Array& bytes, bool dynamic, bool transient = false)
         {
+            if (transient)
+            {
+                m_handle = bgfx::DynamicVertexBufferHandle{bgfx::kInvalidHandle};
+                m_transient = std::make_unique<TransientState>();
+                m_transient->Source = Napi::Persistent(bytes);
+                m_transient->ByteLength = static_cast<uint32_t>(bytes.ByteLength());
+                return;
+            }
+
             if (!dynamic)
             {
+                // Static buffers are never written to again, so the JavaScript array is referenced rather than copied.
                 m_handle = bgfx::VertexBufferHandle{bgfx::kInvalidHandle};
+                m_source = Napi::Persistent(bytes);
             }
             else
             {
                 m_handle = bgfx::DynamicVertexBufferHandle{bgfx::kInvalidHandle};
+                m_bytes.assign(bytes.Data(), bytes.Data() + bytes.ByteLength());
             }
+
+            m_tracked.Track(ResourceType::VertexBuffer, bytes.ByteLength());
         }
 
         ~VertexBufferData()
         {
+            if (m_heap)
+            {
+                m_heap->Free(m_allocation);
+                return;
+            }
+
             constexpr auto nonDynamic = [](auto handle) {
                 if (handle.idx != bgfx::kInvalidHandle)
                 {
@@ -258,22 +463,57 @@ namespace Babylon
             DoForHandleTypes(nonDynamic, dynamic);
         }
 
-        void EnsureFinalized(Napi::Env /*env*/, const bgfx::VertexLayout& layout)
+        /// Creates the bgfx buffer for the first layout the buffer is recorded with. Static buffers that fit in a page
+        /// are sub-allocated from the heap of that layout's stride instead, and move to a buffer of their own when
+        /// later recorded with a stride their place in the page is not aligned to.
+        void EnsureFinalized(JsRuntime& runtime, const bgfx::VertexLayout& layout, GeometryHeaps& heaps)
         {
-            const auto nonDynamic = [&layout, this](auto handle) {
+            if (m_transient)
+            {
+                // Only the stride matters for the transient allocations, and every attribute recorded has the same.
+                if (m_transient->Layout.getStride() == 0)
+                {
+                    m_transient->Layout = layout;
+                }
+                return;
+            }
+
+            const auto nonDynamic = [&runtime, &layout, &heaps, this](auto handle) {
                 if (handle.idx != bgfx::kInvalidHandle)
                 {
                     return;
                 }
 
-                const bgfx::Memory* memory = bgfx::makeRef(
-                    m_bytes.data(), static_cast<uint32_t>(m_bytes.size()), [](void*, void* userData) {
-                        auto* bytes = reinterpret_cast<std::vector<uint8_t>*>(userData);
-                        bytes->clear();
-                    },
-                    &m_bytes);
+                const uint16_t stride = layout.getStride();
+                const bool inHeap = m_heap != nullptr;
+                if (inHeap)
+                {
+                    if (stride == 0 || (m_allocation.Start * m_heapStride) % stride == 0)
+                    {
+                        return;
+                    }
+
+                    // Vertices of this stride cannot be addressed where the buffer sits in the page.
+                    m_heap->Free(m_allocation);
+                    m_heap.reset();
+                }
+
+                // The memory holds its own reference to the array until bgfx is done with it.
+                const Napi::Uint8Array source = m_source.Value();
+                const auto byteLength = static_cast<uint32_t>(source.ByteLength());
+                auto heap = stride != 0 && !inHeap ? heaps.GetVertexHeap(layout) : nullptr;
+                if (auto allocation = heap ? heap->Allocate((byteLength + stride - 1) / stride) : std::nullopt)
+                {
+                    // The array stays referenced while the buffer is in the heap, in case it has to move out.
+                    heap->Update(*allocation, MakeJsArrayRef(runtime, source, source.Data(), byteLength));
+                    m_heap = std::move(heap);
+                    m_heapStride = stride;
+                    m_allocation = *allocation;
+                    return;
+                }
 
-                m_handle = bgfx::createVertexBuffer(memory, layout);
+                m_handle = bgfx::createVertexBuffer(MakeJsArrayRef(runtime, source, source.Data(), byteLength), layout);
+                m_source.Reset();
             };
             const auto dynamic = [&layout, this](auto handle) {
                 if (handle.idx != bgfx::kInvalidHandle)
@@ -288,45 +528,274 @@ namespace Babylon
                     },
                     &m_bytes);
 
-                m_handle = bgfx::createDynamicVertexBuffer(memory, layout);
+                m_handle = bgfx::createDynamicVertexBuffer(memory, layout, BGFX_BUFFER_ALLOW_RESIZE);
+                m_stride = layout.getStride();
             };
             DoForHandleTypes(nonDynamic, dynamic);
         }
 
-        void Update(const Napi::Uint8Array& bytes, uint32_t offset, uint32_t byteLength)
+        /// Writes byteLength bytes of bytes, starting at offset, to the buffer at destinationOffset, which must be
+        /// on a vertex boundary once the buffer has been created. With zeroCopy, bgfx reads the JavaScript array
+        /// directly when it processes the update, so the array must not change until the frame has been rendered.
+        void Update(const Napi::Uint8Array& bytes, uint32_t offset, uint32_t byteLength, uint32_t destinationOffset, bool zeroCopy, JsRuntime& runtime)
         {
+            if (offset > bytes.ByteLength() || byteLength > bytes.ByteLength() - offset)
+            {
+                throw std::runtime_error{"Vertex buffer update range is outside of the source data."};
+            }
+
+            if (m_transient)
+            {
+                m_transient->Source = Napi::Persistent(bytes);
+                m_transient->ByteOffset = offset;
+                m_transient->ByteLength = byteLength;
+                m_transient->FrameIndex = TransientState::kNoFrame;
+                return;
+            }
+
             constexpr auto nonDynamic = [](auto) {
                 throw std::runtime_error("Cannot update non-dynamic vertex buffer.");
             };
-            const auto dynamic = [&bytes, offset, byteLength, this](auto handle) {
+            const auto dynamic = [&bytes, offset, byteLength, destinationOffset, zeroCopy, &runtime, this](auto handle) {
                 if (handle.idx == bgfx::kInvalidHandle)
                 {
-                    // Buffer hasn't been finalized yet, all that's necessary is to swap out the bytes.
-                    m_bytes = {bytes.Data() + offset, bytes.Data() + offset + byteLength};
+                    // Buffer hasn't been finalized yet, all that's necessary is to write into the bytes.
+                    if (m_bytes.size() < destinationOffset + byteLength)
+                    {
+                        m_bytes.resize(destinationOffset + byteLength);
+                    }
+                    std::memcpy(m_bytes.data() + destinationOffset, bytes.Data() + offset, byteLength);
                 }
                 else
                 {
-                    // Buffer was already created, do a real update operation.
-                    const bgfx::Memory* memory = bgfx::copy(bytes.Data() + offset, byteLength);
-                    bgfx::update(handle, 0, memory);
+                    // Buffer was already created, do a real update operation on the affected vertices only.
+                    if (destinationOffset % m_stride != 0)
+                    {
+                        throw std::runtime_error{"Vertex buffer updates must start on a vertex boundary."};
+                    }
+
+                    const uint8_t* data = bytes.Data() + offset;
+                    bgfx::update(handle, destinationOffset / m_stride, zeroCopy ? MakeJsArrayRef(runtime, bytes, data, byteLength) : bgfx::copy(data, byteLength));
                 }
+
+                m_tracked.Track(ResourceType::VertexBuffer, std::max<uint64_t>(m_tracked.GetBytes(), uint64_t{destinationOffset} + byteLength));
             };
             DoForHandleTypes(nonDynamic, dynamic);
         }
 
-        void SetAsBgfxVertexBuffer(uint8_t index, uint32_t startVertex, bgfx::VertexLayoutHandle layout) const
+        /// Binds the buffer from startVertex on, in vertices of byteStride counted from the start of the buffer.
+        void SetAsBgfxVertexBuffer(bgfx::Encoder* encoder, uint8_t index, uint32_t startVertex, uint32_t byteStride, bgfx::VertexLayoutHandle layout, uint32_t frameIndex) const
         {
-            const auto nonDynamic = [index, startVertex, layout](auto handle) {
-                bgfx::setVertexBuffer(index, handle, startVertex, UINT32_MAX, layout);
+            if (m_transient)
+            {
+                // The vertices are copied once per frame, into memory bgfx recycles when the frame ends.
+                if (m_transient->FrameIndex != frameIndex)
+                {
+                    const uint32_t count = m_transient->ByteLength / m_transient->Layout.getStride();
+                    if (bgfx::getAvailTransientVertexBuffer(count, m_transient->Layout) < count)
+                    {
+                        throw std::runtime_error{"Out of transient vertex buffer memory for this frame."};
+                    }
+
+                    const Napi::Uint8Array source = m_transient->Source.Value();
+                    bgfx::allocTransientVertexBuffer(&m_transient->Buffer, count, m_transient->Layout);
+                    std::memcpy(m_transient->Buffer.data, source.Data() + m_transient->ByteOffset, count * m_transient->Layout.getStride());
+                    m_transient->FrameIndex = frameIndex;
+                }
+
+                encoder->setVertexBuffer(index, &m_transient->Buffer, startVertex, UINT32_MAX, layout);
+                return;
+            }
+
+            if (m_heap)
+            {
+                // EnsureFinalized moves the buffer out of the heap when its place in the page is not a whole
+                // number of vertices of a stride it is recorded with.
+                const uint32_t pageStartVertex = m_allocation.Start * m_heapStride / byteStride;
+                encoder->setVertexBuffer(index, bgfx::DynamicVertexBufferHandle{m_allocation.Handle}, pageStartVertex + startVertex, UINT32_MAX, layout);
+                return;
+            }
+
+            const auto nonDynamic = [encoder, index, startVertex, layout](auto handle) {
+                encoder->setVertexBuffer(index, handle, startVertex, UINT32_MAX, layout);
             };
-            const auto dynamic = [index, startVertex, layout](auto handle) {
-                bgfx::setVertexBuffer(index, handle, startVertex, UINT32_MAX, layout);
+            const auto dynamic = [encoder, index, startVertex, layout](auto handle) {
+                encoder->setVertexBuffer(index, handle, startVertex, UINT32_MAX, layout);
             };
             DoForHandleTypes(nonDynamic, dynamic);
         }
 
     private:
+        // Transient buffers reference the JavaScript data instead of owning a bgfx buffer, and copy it into a
+        // bgfx transient buffer the first time they are bound in a frame.
+        struct TransientState
+        {
+            static constexpr uint32_t kNoFrame{std::numeric_limits<uint32_t>::max()};
+
+            Napi::Reference<Napi::Uint8Array> Source{};
+            uint32_t ByteOffset{};
+            uint32_t ByteLength{};
+            bgfx::VertexLayout Layout{};
+            bgfx::TransientVertexBuffer Buffer{};
+            uint32_t FrameIndex{kNoFrame};
+        };
+
+        Napi::Reference<Napi::Uint8Array> m_source{};
         std::vector<uint8_t> m_bytes{};
+        uint32_t m_stride{};
+        std::unique_ptr<TransientState> m_transient{};
+        std::shared_ptr<GeometryHeap> m_heap{};
+        uint32_t m_heapStride{};
+        GeometryHeap::Allocation m_allocation{};
+        TrackedResource m_tracked{};
+    };
+
+    class InstanceBufferData final
+    {
+    public:
+        // bgfx exposes up to five vec4 of instance data to shaders, as i_data0 through i_data4.
+        static constexpr uint32_t MaxStride{5 * 4 * sizeof(float)};
+
+        InstanceBufferData(const Napi::Uint8Array& bytes, uint32_t stride)
+            : m_stride{stride}
+        {
+            if (stride == 0 || stride % (4 * sizeof(float)) != 0 || stride > MaxStride)
+            {
+                throw std::runtime_error{"Instance buffer stride must be a multiple of 16 bytes between 16 and 80 bytes."};
+            }
+
+            if (bytes.ByteLength() % stride != 0)
+            {
+                throw std::runtime_error{"Instance buffer data must hold a whole number of instances."};
+            }
+
+            // The layout only provides the stride to bgfx; instance data is bound by position, not by attribute.
+            bgfx::VertexLayout layout{};
+            layout.begin();
+            for (uint32_t index = 0; index < stride / (4 * sizeof(float)); ++index)
+            {
+                layout.add(static_cast<bgfx::Attrib::Enum>(bgfx::Attrib::TexCoord7 - index), 4, bgfx::AttribType::Float);
+            }
+            layout.end();
+
+            const bgfx::Memory* memory = bgfx::copy(bytes.Data(), static_cast<uint32_t>(bytes.ByteLength()));
+            m_handle = bgfx::createDynamicVertexBuffer(memory, layout, BGFX_BUFFER_ALLOW_RESIZE);
+            m_tracked.Track(ResourceType::InstanceBuffer, bytes.ByteLength());
+        }
+
+        ~InstanceBufferData()
+        {
+            bgfx::destroy(m_handle);
+        }
+
+        void Update(const Napi::Uint8Array& bytes, uint32_t byteOffset)
+        {
+            if (byteOffset % m_stride != 0 || bytes.ByteLength() % m_stride != 0)
+            {
+                throw std::runtime_error{"Instance buffer updates must start on an instance boundary and hold whole instances."};
+            }
+
+            const bgfx::Memory* memory = bgfx::copy(bytes.Data(), static_cast<uint32_t>(bytes.ByteLength()));
+            bgfx::update(m_handle, byteOffset / m_stride, memory);
+            m_tracked.Track(ResourceType::InstanceBuffer, std::max<uint64_t>(m_tracked.GetBytes(), byteOffset + bytes.ByteLength()));
+        }
+
+        void SetAsBgfxInstanceDataBuffer(bgfx::Encoder* encoder, uint32_t startInstance, uint32_t numInstances) const
+        {
+            encoder->setInstanceDataBuffer(m_handle, startInstance, numInstances);
+        }
+
+    private:
+        bgfx::DynamicVertexBufferHandle m_handle{bgfx::kInvalidHandle};
+        uint32_t m_stride{};
+        TrackedResource m_tracked{};
+    };
+
+    class OcclusionQueryData final
+    {
+    public:
+        explicit OcclusionQueryData(bgfx::OcclusionQueryHandle handle)
+            : Handle{handle}
+        {
+        }
+
+        ~OcclusionQueryData()
+        {
+            bgfx::destroy(Handle);
+        }
+
+        const bgfx::OcclusionQueryHandle Handle;
+    };
+
+    class StorageBufferData final
+    {
+    public:
+        // bgfx types the views of compute vertex buffers as vec4 of floats.
+        static constexpr uint32_t ElementSize{4 * sizeof(float)};
+
+        explicit StorageBufferData(uint32_t byteLength)
+        {
+            m_handle = bgfx::createDynamicVertexBuffer(ElementCount(byteLength), Layout(), BGFX_BUFFER_COMPUTE_READ_WRITE);
+            m_tracked.Track(ResourceType::StorageBuffer, byteLength);
+        }
+
+        explicit StorageBufferData(const Napi::Uint8Array& bytes)
+        {
+            ElementCount(static_cast<uint32_t>(bytes.ByteLength()));
+
+            const bgfx::Memory* memory = bgfx::copy(bytes.Data(), static_cast<uint32_t>(bytes.ByteLength()));
+            m_handle = bgfx::createDynamicVertexBuffer(memory, Layout(), BGFX_BUFFER_COMPUTE_READ_WRITE);
+            m_tracked.Track(ResourceType::StorageBuffer, bytes.ByteLength());
+        }
+
+        ~StorageBufferData()
+        {
+            bgfx::destroy(m_handle);
+        }
+
+        void Update(const Napi::Uint8Array& bytes, uint32_t byteOffset)
+        {
+            if (byteOffset % ElementSize != 0)
+            {
+                throw std::runtime_error{"Storage buffer updates must start on a 16-byte boundary."};
+            }
+
+            ElementCount(static_cast<uint32_t>(bytes.ByteLength()));
+
+            const bgfx::Memory* memory = bgfx::copy(bytes.Data(), static_cast<uint32_t>(bytes.ByteLength()));
+            bgfx::update(m_handle, byteOffset / ElementSize, memory);
+        }
+
+        void SetAsBgfxComputeBuffer(bgfx::Encoder* encoder, uint8_t stage, bgfx::Access::Enum access) const
+        {
+            encoder->setBuffer(stage, m_handle, access);
+        }
+
+    private:
+        static uint32_t ElementCount(uint32_t byteLength)
+        {
+            if (byteLength == 0 || byteLength % ElementSize != 0)
+            {
+                throw std::runtime_error{"Storage buffer sizes must be a non-zero multiple of 16 bytes."};
+            }
+
+            return byteLength / ElementSize;
+        }
+
+        static const bgfx::VertexLayout& Layout()
+        {
+            static const bgfx::VertexLayout layout{[]() {
+                bgfx::VertexLayout result{};
+                result.begin();
+                result.add(bgfx::Attrib::TexCoord0, 4, bgfx::AttribType::Float);
+                result.end();
+                return result;
+            }()};
+            return layout;
+        }
+
+        bgfx::DynamicVertexBufferHandle m_handle{bgfx::kInvalidHandle};
+        TrackedResource m_tracked{};
     };
 
     void NativeEngine::Initialize(Napi::Env env, bool autoRender)
@@ -351,10 +820,26 @@ namespace Babylon
                 InstanceMethod("deleteVertexBuffer", &NativeEngine::DeleteVertexBuffer),
                 InstanceMethod("recordVertexBuffer", &NativeEngine::RecordVertexBuffer),
                 InstanceMethod("updateDynamicVertexBuffer", &NativeEngine::UpdateDynamicVertexBuffer),
+                InstanceMethod("createInstanceBuffer", &NativeEngine::CreateInstanceBuffer),
+                InstanceMethod("deleteInstanceBuffer", &NativeEngine::DeleteInstanceBuffer),
+                InstanceMethod("updateInstanceBuffer", &NativeEngine::UpdateInstanceBuffer),
                 InstanceMethod("createProgram", &NativeEngine::CreateProgram),
                 InstanceMethod("getUniforms", &NativeEngine::GetUniforms),
+                InstanceMethod("createComputeProgram", &NativeEngine::CreateComputeProgram),
+                InstanceMethod("getComputeBindings", &NativeEngine::GetComputeBindings),
+                InstanceMethod("createStorageBuffer", &NativeEngine::CreateStorageBuffer),
+                InstanceMethod("deleteStorageBuffer", &NativeEngine::DeleteStorageBuffer),
+                InstanceMethod("updateStorageBuffer", &NativeEngine::UpdateStorageBuffer),
+                InstanceMethod("createStorageTexture", &NativeEngine::CreateStorageTexture),
+                InstanceMethod("setComputeBuffer", &NativeEngine::SetComputeBuffer),
+                InstanceMethod("setComputeImage", &NativeEngine::SetComputeImage),
+                InstanceMethod("dispatchCompute", &NativeEngine::DispatchCompute),
                 InstanceMethod("getAttributes", &NativeEngine::GetAttributes),
+                InstanceMethod("getUniformOffsets", &NativeEngine::GetUniformOffsets),
+                InstanceMethod("getUniformSlots", &NativeEngine::GetUniformSlots),
+                InstanceMethod("getAttributeLocations", &NativeEngine::GetAttributeLocations),
                 InstanceMethod("setProgram", &NativeEngine::SetProgram),
+                InstanceMethod("setUniformBlock", &NativeEngine::SetUniformBlock),
                 InstanceMethod("setState", &NativeEngine::SetState),
                 InstanceMethod("setZOffset", &NativeEngine::SetZOffset),
                 InstanceMethod("getZOffset", &NativeEngine::GetZOffset),
@@ -374,6 +859,7 @@ namespace Babylon
                 InstanceMethod("setFloatArray3", &NativeEngine::SetFloatArray3),
                 InstanceMethod("setFloatArray4", &NativeEngine::SetFloatArray4),
                 InstanceMethod("setMatrices", &NativeEngine::SetMatrices),
+                InstanceMethod("composeWorldMatrices", &NativeEngine::ComposeWorldMatrices),
                 InstanceMethod("setMatrix3x3", &NativeEngine::SetMatrix3x3),
                 InstanceMethod("setMatrix2x2", &NativeEngine::SetMatrix2x2),
                 InstanceMethod("setFloat", &NativeEngine::SetFloat),
@@ -397,6 +883,14 @@ namespace Babylon
                 InstanceMethod("bindFramebuffer", &NativeEngine::BindFrameBuffer),
                 InstanceMethod("unbindFramebuffer", &NativeEngine::UnbindFrameBuffer),
                 InstanceMethod("drawIndexed", &NativeEngine::DrawIndexed),
+                InstanceMethod("drawIndexedInstanced", &NativeEngine::DrawIndexedInstanced),
+                InstanceMethod("createOcclusionQuery", &NativeEngine::CreateOcclusionQuery),
+                InstanceMethod("deleteOcclusionQuery", &NativeEngine::DeleteOcclusionQuery),
+                InstanceMethod("beginOcclusionQuery", &NativeEngine::BeginOcclusionQuery),
+                InstanceMethod("endOcclusionQuery", &NativeEngine::EndOcclusionQuery),
+                InstanceMethod("getOcclusionQueryResult", &NativeEngine::GetOcclusionQueryResult),
+                InstanceMethod("beginConditionalRendering", &NativeEngine::BeginConditionalRendering),
+                InstanceMethod("endConditionalRendering", &NativeEngine::EndConditionalRendering),
                 InstanceMethod("draw", &NativeEngine::Draw),
                 InstanceMethod("clear", &NativeEngine::Clear),
                 InstanceMethod("clearColor", &NativeEngine::ClearColor),
@@ -407,6 +901,18 @@ namespace Babylon
                 InstanceMethod("setViewPort", &NativeEngine::SetViewPort),
                 InstanceMethod("getFramebufferData", &NativeEngine::GetFramebufferData),
                 InstanceMethod("getRenderAPI", &NativeEngine::GetRenderAPI),
+                InstanceMethod("submitCommands", &NativeEngine::SubmitCommands),
+                InstanceMethod("getInstancingStats", &NativeEngine::GetInstancingStats),
+                InstanceMethod("getResourceStats", &NativeEngine::GetResourceStats),
+                InstanceMethod("getFrameStats", &NativeEngine::GetFrameStats),
+                InstanceMethod("setViewProfilingEnabled", &NativeEngine::SetViewProfilingEnabled),
+                InstanceMethod("setFrameBufferName", &NativeEngine::SetFrameBufferName),
+                InstanceMethod("setTextureStreamingBudget", &NativeEngine::SetTextureStreamingBudget),
+                InstanceMethod("setGpuMipGenerationEnabled", &NativeEngine::SetGpuMipGenerationEnabled),
+                InstanceMethod("setViewSortMode", &NativeEngine::SetViewSortMode),
+                InstanceMethod("getViewSortStats", &NativeEngine::GetViewSortStats),
+                InstanceMethod("cullBoundingBoxes", &NativeEngine::CullBoundingBoxes),
+                InstanceMethod("cullBoundingSpheres", &NativeEngine::CullBoundingSpheres),
 
                 InstanceValue("TEXTURE_NEAREST_NEAREST", Napi::Number::From(env, TextureSampling::NEAREST_NEAREST)),
                 InstanceValue("TEXTURE_LINEAR_LINEAR", Napi::Number::From(env, TextureSampling::LINEAR_LINEAR)),
@@ -443,6 +949,10 @@ namespace Babylon
                 InstanceValue("TEXTURE_FORMAT_RGBA8", Napi::Number::From(env, static_cast<uint32_t>(bgfx::TextureFormat::RGBA8))),
                 InstanceValue("TEXTURE_FORMAT_RGBA32F", Napi::Number::From(env, static_cast<uint32_t>(bgfx::TextureFormat::RGBA32F))),
 
+                InstanceValue("COMPUTE_ACCESS_READ", Napi::Number::From(env, static_cast<uint32_t>(bgfx::Access::Read))),
+                InstanceValue("COMPUTE_ACCESS_WRITE", Napi::Number::From(env, static_cast<uint32_t>(bgfx::Access::Write))),
+                InstanceValue("COMPUTE_ACCESS_READ_WRITE", Napi::Number::From(env, static_cast<uint32_t>(bgfx::Access::ReadWrite))),
+
                 InstanceValue("ATTRIB_TYPE_UINT8", Napi::Number::From(env, static_cast<uint32_t>(bgfx::AttribType::Uint8))),
                 InstanceValue("ATTRIB_TYPE_INT16", Napi::Number::From(env, static_cast<uint32_t>(bgfx::AttribType::Int16))),
                 InstanceValue("ATTRIB_TYPE_FLOAT", Napi::Number::From(env, static_cast<uint32_t>(bgfx::AttribType::Float))),
@@ -459,6 +969,48 @@ namespace Babylon
                 InstanceValue("ALPHA_INTERPOLATE", Napi::Number::From(env, AlphaMode::INTERPOLATE)),
                 InstanceValue("ALPHA_SCREENMODE", Napi::Number::From(env, AlphaMode::SCREENMODE)),
 
+                InstanceValue("COMMAND_BIND_VERTEX_ARRAY", Napi::Number::From(env, static_cast<uint32_t>(Command::BindVertexArray))),
+                InstanceValue("COMMAND_SET_PROGRAM", Napi::Number::From(env, static_cast<uint32_t>(Command::SetProgram))),
+                InstanceValue("COMMAND_SET_STATE", Napi::Number::From(env, static_cast<uint32_t>(Command::SetState))),
+                InstanceValue("COMMAND_SET_DEPTH_TEST", Napi::Number::From(env, static_cast<uint32_t>(Command::SetDepthTest))),
+                InstanceValue("COMMAND_SET_DEPTH_WRITE", Napi::Number::From(env, static_cast<uint32_t>(Command::SetDepthWrite))),
+                InstanceValue("COMMAND_SET_COLOR_WRITE", Napi::Number::From(env, static_cast<uint32_t>(Command::SetColorWrite))),
+                InstanceValue("COMMAND_SET_BLEND_MODE", Napi::Number::From(env, static_cast<uint32_t>(Command::SetBlendMode))),
+                InstanceValue("COMMAND_SET_MATRIX", Napi::Number::From(env, static_cast<uint32_t>(Command::SetMatrix))),
+                InstanceValue("COMMAND_SET_MATRIX3X3", Napi::Number::From(env, static_cast<uint32_t>(Command::SetMatrix3x3))),
+                InstanceValue("COMMAND_SET_MATRIX2X2", Napi::Number::From(env, static_cast<uint32_t>(Command::SetMatrix2x2))),
+                InstanceValue("COMMAND_SET_MATRICES", Napi::Number::From(env, static_cast<uint32_t>(Command::SetMatrices))),
+                InstanceValue("COMMAND_SET_INT", Napi::Number::From(env, static_cast<uint32_t>(Command::SetInt))),
+                InstanceValue("COMMAND_SET_INT_ARRAY", Napi::Number::From(env, static_cast<uint32_t>(Command::SetIntArray))),
+                InstanceValue("COMMAND_SET_INT_ARRAY2", Napi::Number::From(env, static_cast<uint32_t>(Command::SetIntArray2))),
+                InstanceValue("COMMAND_SET_INT_ARRAY3", Napi::Number::From(env, static_cast<uint32_t>(Command::SetIntArray3))),
+                InstanceValue("COMMAND_SET_INT_ARRAY4", Napi::Number::From(env, static_cast<uint32_t>(Command::SetIntArray4))),
+                InstanceValue("COMMAND_SET_FLOAT_ARRAY", Napi::Number::From(env, static_cast<uint32_t>(Command::SetFloatArray))),
+                InstanceValue("COMMAND_SET_FLOAT_ARRAY2", Napi::Number::From(env, static_cast<uint32_t>(Command::SetFloatArray2))),
+                InstanceValue("COMMAND_SET_FLOAT_ARRAY3", Napi::Number::From(env, static_cast<uint32_t>(Command::SetFloatArray3))),
+                InstanceValue("COMMAND_SET_FLOAT_ARRAY4", Napi::Number::From(env, static_cast<uint32_t>(Command::SetFloatArray4))),
+                InstanceValue("COMMAND_SET_FLOAT", Napi::Number::From(env, static_cast<uint32_t>(Command::SetFloat))),
+                InstanceValue("COMMAND_SET_FLOAT2", Napi::Number::From(env, static_cast<uint32_t>(Command::SetFloat2))),
+                InstanceValue("COMMAND_SET_FLOAT3", Napi::Number::From(env, static_cast<uint32_t>(Command::SetFloat3))),
+                InstanceValue("COMMAND_SET_FLOAT4", Napi::Number::From(env, static_cast<uint32_t>(Command::SetFloat4))),
+                InstanceValue("COMMAND_SET_TEXTURE", Napi::Number::From(env, static_cast<uint32_t>(Command::SetTexture))),
+                InstanceValue("COMMAND_SET_TEXTURE_SAMPLING", Napi::Number::From(env, static_cast<uint32_t>(Command::SetTextureSampling))),
+                InstanceValue("COMMAND_SET_TEXTURE_WRAP_MODE", Napi::Number::From(env, static_cast<uint32_t>(Command::SetTextureWrapMode))),
+                InstanceValue("COMMAND_SET_TEXTURE_ANISOTROPIC_LEVEL", Napi::Number::From(env, static_cast<uint32_t>(Command::SetTextureAnisotropicLevel))),
+                InstanceValue("COMMAND_BIND_FRAMEBUFFER", Napi::Number::From(env, static_cast<uint32_t>(Command::BindFrameBuffer))),
+                InstanceValue("COMMAND_UNBIND_FRAMEBUFFER", Napi::Number::From(env, static_cast<uint32_t>(Command::UnbindFrameBuffer))),
+                InstanceValue("COMMAND_DRAW_INDEXED", Napi::Number::From(env, static_cast<uint32_t>(Command::DrawIndexed))),
+                InstanceValue("COMMAND_DRAW", Napi::Number::From(env, static_cast<uint32_t>(Command::Draw))),
+                InstanceValue("COMMAND_CLEAR", Napi::Number::From(env, static_cast<uint32_t>(Command::Clear))),
+                InstanceValue("COMMAND_CLEAR_COLOR", Napi::Number::From(env, static_cast<uint32_t>(Command::ClearColor))),
+                InstanceValue("COMMAND_CLEAR_DEPTH", Napi::Number::From(env, static_cast<uint32_t>(Command::ClearDepth))),
+                InstanceValue("COMMAND_CLEAR_STENCIL", Napi::Number::From(env, static_cast<uint32_t>(Command::ClearStencil))),
+                InstanceValue("COMMAND_SET_VIEW_PORT", Napi::Number::From(env, static_cast<uint32_t>(Command::SetViewPort))),
+
+                InstanceValue("VIEW_SORT_MODE_DEFAULT", Napi::Number::From(env, static_cast<uint32_t>(ViewSortMode::Default))),
+                InstanceValue("VIEW_SORT_MODE_SEQUENTIAL", Napi::Number::From(env, static_cast<uint32_t>(ViewSortMode::Sequential))),
+                InstanceValue("VIEW_SORT_MODE_AUTO", Napi::Number::From(env, static_cast<uint32_t>(ViewSortMode::Auto))),
+
                 InstanceValue(JS_AUTO_RENDER_PROPERTY_NAME, Napi::Boolean::New(env, autoRender))});
 
         JsRuntime::NativeObject::GetFromJavaScript(env).Set(JS_ENGINE_CONSTRUCTOR_NAME, func);
@@ -475,6 +1027,7 @@ namespace Babylon
         , RuntimeScheduler{runtime}
         , m_runtime{runtime}
         , m_graphicsImpl{Graphics::Impl::GetFromJavaScript(info.Env())}
+        , m_encoder{m_graphicsImpl.GetDefaultEncoder()}
         , m_engineState{BGFX_STATE_DEFAULT}
         , m_resizeCallbackTicket{nativeWindow.AddOnResizeCallback([this](size_t width, size_t height) { this->UpdateSize(width, height); })}
     {
@@ -494,10 +1047,11 @@ namespace Babylon
         auto bgfxStats = bgfx::getStats();
         if (w != bgfxStats->width || h != bgfxStats->height)
         {
+            FlushPendingDraw();
             bgfx::reset(w, h, BGFX_RESET_FLAGS);
             bgfx::setViewRect(0, 0, 0, w, h);
 #ifdef __APPLE__
-            bgfx::frame();
+            m_graphicsImpl.Frame();
 #else
             bgfx::touch(0);
 #endif
@@ -512,6 +1066,8 @@ namespace Babylon
 
             try
             {
+                GenerateQueuedMips();
+
                 if (!m_requestAnimationFrameCallback.IsEmpty())
                 {
                     // We can get here from either the normal RequestAnimationFrame or the XR RequestAnimationFrame,
@@ -520,7 +1076,14 @@ namespace Babylon
                     auto callback{std::move(m_requestAnimationFrameCallback)};
                     callback({});
                 }
+                FlushPendingDraw();
+                m_textureStreamer.Update([this](bgfx::TextureHandle handle) {
+                    ForgetTextureBindings(handle);
+                    bgfx::destroy(handle);
+                });
+                CountAutoSortSavings();
                 GetFrameBufferManager().Reset();
+                m_lastUniformSubmitState = {};
             }
             catch (const std::exception& ex)
             {
@@ -564,9 +1127,20 @@ namespace Babylon
     void NativeEngine::Dispose()
     {
         m_cancelSource.cancel();
+        m_lifetime.reset();
 
-        // This collection contains bgfx data, so it must be cleared before bgfx::shutdown is called.
+        m_pendingDraw = {};
+
+        // These collections contain bgfx data, so they must be cleared before bgfx::shutdown is called.
         m_programDataCollection.clear();
+        m_textureStreamer.Clear();
+        m_geometryHeaps.Dispose();
+
+        for (const auto& mipGeneration : m_mipGenerationQueue)
+        {
+            bgfx::destroy(mipGeneration.FrameBuffer);
+        }
+        m_mipGenerationQueue.clear();
     }
 
     void NativeEngine::Dispose(const Napi::CallbackInfo& /*info*/)
@@ -595,17 +1169,35 @@ namespace Babylon
 
     Napi::Value NativeEngine::CreateVertexArray(const Napi::CallbackInfo& info)
     {
-        return Napi::External<VertexArray>::New(info.Env(), new VertexArray{});
+        return Napi::External<VertexArray>::New(info.Env(), new VertexArray{m_vertexLayoutCache});
     }
 
     void NativeEngine::DeleteVertexArray(const Napi::CallbackInfo& info)
     {
-        delete info[0].As<Napi::External<VertexArray>>().Data();
+        const auto vertexArray = info[0].As<Napi::External<VertexArray>>().Data();
+
+        FlushPendingDraw();
+        if (m_currentVertexArray == vertexArray)
+        {
+            m_currentVertexArray = nullptr;
+        }
+
+        delete vertexArray;
     }
 
     void NativeEngine::BindVertexArray(const Napi::CallbackInfo& info)
     {
-        const auto& vertexArray = *(info[0].As<Napi::External<VertexArray>>().Data());
+        BindVertexArray(*(info[0].As<Napi::External<VertexArray>>().Data()));
+    }
+
+    void NativeEngine::BindVertexArray(const VertexArray& vertexArray)
+    {
+        if (&vertexArray != m_pendingDraw.BoundVertexArray)
+        {
+            FlushPendingDraw();
+        }
+
+        m_currentVertexArray = &vertexArray;
 
         // a vertex array might not have an index buffer associated with
         m_currentBoundIndexBuffer = vertexArray.indexBuffer.data;
@@ -614,7 +1206,7 @@ namespace Babylon
         for (uint8_t index = 0; index < vertexBuffers.size(); ++index)
         {
             const auto& vertexBuffer = vertexBuffers[index];
-            vertexBuffer.data->SetAsBgfxVertexBuffer(index, vertexBuffer.startVertex, vertexBuffer.vertexLayoutHandle);
+            vertexBuffer.data->SetAsBgfxVertexBuffer(m_encoder, index, vertexBuffer.startVertex, vertexBuffer.byteStride, vertexBuffer.vertexLayoutHandle, m_graphicsImpl.GetFrameIndex());
         }
     }
 
@@ -622,15 +1214,17 @@ namespace Babylon
     {
         const Napi::TypedArray data = info[0].As<Napi::TypedArray>();
         const bool dynamic = info[1].As<Napi::Boolean>().Value();
+        const bool transient = info[2].IsBoolean() && info[2].As<Napi::Boolean>().Value();
 
         const uint16_t flags = data.TypedArrayType() == napi_typedarray_type::napi_uint16_array ? 0 : BGFX_BUFFER_INDEX32;
 
-        return Napi::External<IndexBufferData>::New(info.Env(), new IndexBufferData(data, flags, dynamic));
+        return Napi::External<IndexBufferData>::New(info.Env(), new IndexBufferData(data, flags, dynamic, m_runtime, dynamic || transient ? nullptr : m_geometryHeaps.GetIndexHeap(flags), transient));
     }
 
     void NativeEngine::DeleteIndexBuffer(const Napi::CallbackInfo& info)
     {
         IndexBufferData* indexBufferData = info[0].As<Napi::External<IndexBufferData>>().Data();
+        FlushPendingDraw();
         delete indexBufferData;
     }
 
@@ -639,6 +1233,7 @@ namespace Babylon
         VertexArray& vertexArray = *(info[0].As<Napi::External<VertexArray>>().Data());
         const IndexBufferData* indexBufferData = info[1].As<Napi::External<IndexBufferData>>().Data();
 
+        FlushPendingDraw();
         vertexArray.indexBuffer.data = indexBufferData;
     }
 
@@ -648,21 +1243,24 @@ namespace Babylon
 
         const Napi::TypedArray data = info[1].As<Napi::TypedArray>();
         const uint32_t startingIdx = info[2].As<Napi::Number>().Uint32Value();
+        const bool zeroCopy = info.Length() > 3 && info[3].ToBoolean().Value();
 
-        indexBufferData.Update(data, startingIdx);
+        indexBufferData.Update(data, startingIdx, zeroCopy, m_runtime);
     }
 
     Napi::Value NativeEngine::CreateVertexBuffer(const Napi::CallbackInfo& info)
     {
         const Napi::Uint8Array data = info[0].As<Napi::Uint8Array>();
         const bool dynamic = info[1].As<Napi::Boolean>().Value();
+        const bool transient = info[2].IsBoolean() && info[2].As<Napi::Boolean>().Value();
 
-        return Napi::External<VertexBufferData>::New(info.Env(), new VertexBufferData(data, dynamic));
+        return Napi::External<VertexBufferData>::New(info.Env(), new VertexBufferData(data, dynamic, transient));
     }
 
     void NativeEngine::DeleteVertexBuffer(const Napi::CallbackInfo& info)
     {
         auto* vertexBufferData = info[0].As<Napi::External<VertexBufferData>>().Data();
+        FlushPendingDraw();
         delete vertexBufferData;
     }
 
@@ -678,17 +1276,20 @@ namespace Babylon
         const uint32_t type = info[6].As<Napi::Number>().Uint32Value();
         const bool normalized = info[7].As<Napi::Boolean>().Value();
 
-        bgfx::VertexLayout vertexLayout{};
-        vertexLayout.begin();
         const bgfx::Attrib::Enum attrib = static_cast<bgfx::Attrib::Enum>(location);
         const auto attribType = static_cast<bgfx::AttribType::Enum>(type);
+
+        bgfx::VertexLayout vertexLayout{};
+        vertexLayout.begin();
         vertexLayout.add(attrib, static_cast<uint8_t>(numElements), attribType, normalized);
         vertexLayout.m_stride = static_cast<uint16_t>(byteStride);
         vertexLayout.end();
 
-        vertexBufferData->EnsureFinalized(info.Env(), vertexLayout);
+        vertexBufferData->EnsureFinalized(m_runtime, vertexLayout, m_geometryHeaps);
 
-        vertexArray.vertexBuffers.push_back({vertexBufferData, byteOffset / byteStride, bgfx::createVertexLayout(vertexLayout)});
+        FlushPendingDraw();
+        const bgfx::VertexLayoutHandle vertexLayoutHandle = m_vertexLayoutCache.Acquire(attrib, static_cast<uint8_t>(numElements), attribType, normalized, static_cast<uint16_t>(byteStride));
+        vertexArray.vertexBuffers.push_back({vertexBufferData, byteOffset / byteStride, byteStride, vertexLayoutHandle});
     }
 
     void NativeEngine::UpdateDynamicVertexBuffer(const Napi::CallbackInfo& info)
@@ -697,54 +1298,91 @@ namespace Babylon
         const Napi::Uint8Array data = info[1].As<Napi::Uint8Array>();
         const uint32_t byteOffset = info[2].As<Napi::Number>().Uint32Value();
 
-        uint32_t byteLength = info[2].As<Napi::Number>().Uint32Value();
+        uint32_t byteLength = info[3].As<Napi::Number>().Uint32Value();
         if (byteLength == 0)
         {
-            byteLength = static_cast<uint32_t>(data.ByteLength());
+            byteLength = static_cast<uint32_t>(data.ByteLength()) - std::min(byteOffset, static_cast<uint32_t>(data.ByteLength()));
         }
 
-        vertexBufferData.Update(data, byteOffset, byteLength);
+        const uint32_t destinationByteOffset = info.Length() > 4 && info[4].IsNumber() ? info[4].As<Napi::Number>().Uint32Value() : 0;
+        const bool zeroCopy = info.Length() > 5 && info[5].ToBoolean().Value();
+
+        vertexBufferData.Update(data, byteOffset, byteLength, destinationByteOffset, zeroCopy, m_runtime);
+    }
+
+    Napi::Value NativeEngine::CreateInstanceBuffer(const Napi::CallbackInfo& info)
+    {
+        const Napi::Uint8Array data = info[0].As<Napi::Uint8Array>();
+        const uint32_t byteStride = info[1].As<Napi::Number>().Uint32Value();
+
+        return Napi::External<InstanceBufferData>::New(info.Env(), new InstanceBufferData(data, byteStride));
+    }
+
+    void NativeEngine::DeleteInstanceBuffer(const Napi::CallbackInfo& info)
+    {
+        auto* instanceBufferData = info[0].As<Napi::External<InstanceBufferData>>().Data();
+        delete instanceBufferData;
+    }
+
+    void NativeEngine::UpdateInstanceBuffer(const Napi::CallbackInfo& info)
+    {
+        InstanceBufferData& instanceBufferData = *(info[0].As<Napi::External<InstanceBufferData>>().Data());
+        const Napi::Uint8Array data = info[1].As<Napi::Uint8Array>();
+        const uint32_t byteOffset = info[2].IsUndefined() ? 0 : info[2].As<Napi::Number>().Uint32Value();
+
+        instanceBufferData.Update(data, byteOffset);
     }
 
     Napi::Value NativeEngine::CreateProgram(const Napi::CallbackInfo& info)
     {
         const std::string vertexSource{info[0].As<Napi::String>().Utf8Value()};
         const std::string fragmentSource{info[1].As<Napi::String>().Utf8Value()};
+        const bool autoInstancing{info[2].IsBoolean() && info[2].As<Napi::Boolean>().Value()};
 
         std::unique_ptr<ProgramData> programData{std::make_unique<ProgramData>()};
         ShaderCompiler::BgfxShaderInfo shaderInfo{m_shaderCompiler.Compile(vertexSource, fragmentSource)};
 
-        static auto InitUniformInfos{[](bgfx::ShaderHandle shader, const std::unordered_map<std::string, uint8_t>& uniformStages, std::unordered_map<std::string, UniformInfo>& uniformInfos) {
-            auto numUniforms = bgfx::getShaderUniforms(shader);
-            std::vector<bgfx::UniformHandle> uniforms{numUniforms};
-            bgfx::getShaderUniforms(shader, uniforms.data(), gsl::narrow_cast<uint16_t>(uniforms.size()));
-
-            for (uint8_t index = 0; index < numUniforms; index++)
-            {
-                bgfx::UniformInfo info{};
-                bgfx::getUniformInfo(uniforms[index], info);
-                auto itStage = uniformStages.find(info.name);
-                uniformInfos[info.name] = {itStage == uniformStages.end() ? uint8_t{} : itStage->second, uniforms[index]};
-                bool YFlip{false};
-                if (!bgfx::getCaps()->originBottomLeft)
-                {
-                    YFlip = (!strcmp(info.name, "projection")) || (!strcmp(info.name, "viewProjection"));
-                }
-                uniformInfos[info.name].YFlip = YFlip;
-            }
-        }};
-
         auto vertexShader = bgfx::createShader(bgfx::copy(shaderInfo.VertexBytes.data(), static_cast<uint32_t>(shaderInfo.VertexBytes.size())));
-        InitUniformInfos(vertexShader, shaderInfo.VertexUniformStages, programData->VertexUniformInfos);
+        InitUniformInfos(vertexShader, shaderInfo.VertexUniformStages, programData->VertexUniformInfos, *programData);
         programData->VertexAttributeLocations = std::move(shaderInfo.VertexAttributeLocations);
 
         auto fragmentShader = bgfx::createShader(bgfx::copy(shaderInfo.FragmentBytes.data(), static_cast<uint32_t>(shaderInfo.FragmentBytes.size())));
-        InitUniformInfos(fragmentShader, shaderInfo.FragmentUniformStages, programData->FragmentUniformInfos);
+        InitUniformInfos(fragmentShader, shaderInfo.FragmentUniformStages, programData->FragmentUniformInfos, *programData);
 
         programData->Program = bgfx::createProgram(vertexShader, fragmentShader, true);
+        programData->BuildReflection();
+        uint64_t programBytes{shaderInfo.VertexBytes.size() + shaderInfo.FragmentBytes.size()};
+
+        // Automatic instancing needs a variant of the program taking the world matrix from instance data, which
+        // is only possible if the world matrix is a single matrix used by the vertex shader alone.
+        const auto world = programData->VertexUniformInfos.find("world");
+        if (autoInstancing &&
+            world != programData->VertexUniformInfos.end() &&
+            world->second.Slot != UniformInfo::kInvalidSlot &&
+            programData->Uniforms[world->second.Slot].Capacity == 16 &&
+            programData->Uniforms[world->second.Slot].ElementSize == 16 &&
+            programData->FragmentUniformInfos.find("world") == programData->FragmentUniformInfos.end())
+        {
+            ShaderCompiler::BgfxShaderInfo instancedShaderInfo{m_shaderCompiler.Compile(vertexSource, fragmentSource, true)};
+            auto instancedVertexShader = bgfx::createShader(bgfx::copy(instancedShaderInfo.VertexBytes.data(), static_cast<uint32_t>(instancedShaderInfo.VertexBytes.size())));
+            auto instancedFragmentShader = bgfx::createShader(bgfx::copy(instancedShaderInfo.FragmentBytes.data(), static_cast<uint32_t>(instancedShaderInfo.FragmentBytes.size())));
+            programData->InstancedProgram = bgfx::createProgram(instancedVertexShader, instancedFragmentShader, true);
+            programData->WorldSlot = world->second.Slot;
+            programBytes += instancedShaderInfo.VertexBytes.size() + instancedShaderInfo.FragmentBytes.size();
+        }
+
+        programData->Tracked.Track(ResourceType::Program, programBytes);
+
         auto* rawProgramData = programData.get();
         auto ticket = m_programDataCollection.insert(std::move(programData));
-        auto finalizer = [ticket = std::move(ticket)](Napi::Env, ProgramData*) {};
+        auto finalizer = [lifetime = std::weak_ptr<NativeEngine*>{m_lifetime}, ticket = std::move(ticket)](Napi::Env, ProgramData* programData) {
+            // A held back draw must not outlive its program.
+            const auto engine = lifetime.lock();
+            if (engine && (*engine)->m_pendingDraw.Program == programData)
+            {
+                (*engine)->FlushPendingDraw();
+            }
+        };
         return Napi::External<ProgramData>::New(info.Env(), rawProgramData, std::move(finalizer));
     }
 
@@ -761,6 +1399,7 @@ namespace Babylon
 
             auto vertexFound = program->VertexUniformInfos.find(name);
             auto fragmentFound = program->FragmentUniformInfos.find(name);
+            auto computeFound = program->ComputeUniformInfos.find(name);
 
             if (vertexFound != program->VertexUniformInfos.end())
             {
@@ -770,6 +1409,10 @@ namespace Babylon
             {
                 uniforms[index] = Napi::External<UniformInfo>::New(info.Env(), &fragmentFound->second);
             }
+            else if (computeFound != program->ComputeUniformInfos.end())
+            {
+                uniforms[index] = Napi::External<UniformInfo>::New(info.Env(), &computeFound->second);
+            }
             else
             {
                 uniforms[index] = info.Env().Null();
@@ -779,6 +1422,157 @@ namespace Babylon
         return std::move(uniforms);
     }
 
+    Napi::Value NativeEngine::CreateComputeProgram(const Napi::CallbackInfo& info)
+    {
+        if ((bgfx::getCaps()->supported & BGFX_CAPS_COMPUTE) == 0)
+        {
+            return info.Env().Null();
+        }
+
+        const std::string computeSource{info[0].As<Napi::String>().Utf8Value()};
+
+        std::unique_ptr<ProgramData> programData{std::make_unique<ProgramData>()};
+        ShaderCompiler::BgfxComputeShaderInfo shaderInfo{m_shaderCompiler.CompileCompute(computeSource)};
+
+        auto computeShader = bgfx::createShader(bgfx::copy(shaderInfo.ComputeBytes.data(), static_cast<uint32_t>(shaderInfo.ComputeBytes.size())));
+        InitUniformInfos(computeShader, shaderInfo.ComputeUniformStages, programData->ComputeUniformInfos, *programData);
+        programData->ComputeStorageStages = std::move(shaderInfo.ComputeStorageStages);
+        programData->IsCompute = true;
+
+        programData->Program = bgfx::createProgram(computeShader, true);
+        programData->BuildReflection();
+        programData->Tracked.Track(ResourceType::Program, shaderInfo.ComputeBytes.size());
+
+        auto* rawProgramData = programData.get();
+        auto ticket = m_programDataCollection.insert(std::move(programData));
+        auto finalizer = [ticket = std::move(ticket)](Napi::Env, ProgramData*) {};
+        return Napi::External<ProgramData>::New(info.Env(), rawProgramData, std::move(finalizer));
+    }
+
+    Napi::Value NativeEngine::GetComputeBindings(const Napi::CallbackInfo& info)
+    {
+        const auto program = info[0].As<Napi::External<ProgramData>>().Data();
+        const auto names = info[1].As<Napi::Array>();
+
+        auto length = names.Length();
+        auto stages = Napi::Array::New(info.Env(), length);
+        for (uint32_t index = 0; index < length; ++index)
+        {
+            const auto found = program->ComputeStorageStages.find(names[index].As<Napi::String>().Utf8Value());
+            if (found != program->ComputeStorageStages.end())
+            {
+                stages[index] = Napi::Number::From(info.Env(), found->second);
+            }
+            else
+            {
+                stages[index] = info.Env().Null();
+            }
+        }
+
+        return std::move(stages);
+    }
+
+    Napi::Value NativeEngine::CreateStorageBuffer(const Napi::CallbackInfo& info)
+    {
+        if (info[0].IsNumber())
+        {
+            return Napi::External<StorageBufferData>::New(info.Env(), new StorageBufferData(info[0].As<Napi::Number>().Uint32Value()));
+        }
+
+        return Napi::External<StorageBufferData>::New(info.Env(), new StorageBufferData(info[0].As<Napi::Uint8Array>()));
+    }
+
+    void NativeEngine::DeleteStorageBuffer(const Napi::CallbackInfo& info)
+    {
+        auto* storageBufferData = info[0].As<Napi::External<StorageBufferData>>().Data();
+        delete storageBufferData;
+    }
+
+    void NativeEngine::UpdateStorageBuffer(const Napi::CallbackInfo& info)
+    {
+        StorageBufferData& storageBufferData = *(info[0].As<Napi::External<StorageBufferData>>().Data());
+        const Napi::Uint8Array data = info[1].As<Napi::Uint8Array>();
+        const uint32_t byteOffset = info[2].IsUndefined() ? 0 : info[2].As<Napi::Number>().Uint32Value();
+
+        storageBufferData.Update(data, byteOffset);
+    }
+
+    Napi::Value NativeEngine::CreateStorageTexture(const Napi::CallbackInfo& info)
+    {
+        const auto width = static_cast<uint16_t>(info[0].As<Napi::Number>().Uint32Value());
+        const auto height = static_cast<uint16_t>(info[1].As<Napi::Number>().Uint32Value());
+        const auto format = static_cast<bgfx::TextureFormat::Enum>(info[2].As<Napi::Number>().Uint32Value());
+
+        // Storage textures can also be sampled, so that draws can read what compute shaders wrote.
+        auto* texture = new TextureData();
+        texture->Handle = bgfx::createTexture2D(width, height, false, 1, format, BGFX_TEXTURE_COMPUTE_WRITE);
+        texture->Width = width;
+        texture->Height = height;
+        texture->Tracked.Track(ResourceType::Texture, TextureBytes(width, height, false, format));
+        return Napi::External<TextureData>::New(info.Env(), texture);
+    }
+
+    void NativeEngine::SetComputeBuffer(const Napi::CallbackInfo& info)
+    {
+        const auto stage = static_cast<uint8_t>(info[0].As<Napi::Number>().Uint32Value());
+        const auto buffer = info[1].As<Napi::External<StorageBufferData>>().Data();
+        const auto access = static_cast<bgfx::Access::Enum>(info[2].As<Napi::Number>().Uint32Value());
+
+        // The binding would otherwise also apply to the draw held back.
+        FlushPendingDraw();
+        buffer->SetAsBgfxComputeBuffer(m_encoder, stage, access);
+        m_computeStages.push_back(stage);
+    }
+
+    void NativeEngine::SetComputeImage(const Napi::CallbackInfo& info)
+    {
+        const auto stage = static_cast<uint8_t>(info[0].As<Napi::Number>().Uint32Value());
+        const auto texture = info[1].As<Napi::External<TextureData>>().Data();
+        const auto mip = static_cast<uint8_t>(info[2].As<Napi::Number>().Uint32Value());
+        const auto access = static_cast<bgfx::Access::Enum>(info[3].As<Napi::Number>().Uint32Value());
+
+        FlushPendingDraw();
+        m_encoder->setImage(stage, texture->Handle, mip, access);
+        m_computeStages.push_back(stage);
+    }
+
+    void NativeEngine::DispatchCompute(const Napi::CallbackInfo& info)
+    {
+        const auto numX = info[0].As<Napi::Number>().Uint32Value();
+        const auto numY = info[1].As<Napi::Number>().Uint32Value();
+        const auto numZ = info[2].As<Napi::Number>().Uint32Value();
+
+        if (m_currentProgram == nullptr || !m_currentProgram->IsCompute)
+        {
+            throw std::runtime_error{"dispatchCompute needs a compute program to be the current program."};
+        }
+
+        FlushPendingDraw();
+
+        // bgfx runs the dispatches of a view before its draws.
+        const bgfx::ViewId viewId = m_frameBufferManager.GetBound().ViewId;
+        m_frameBufferManager.MarkViewUsed(viewId);
+
+        m_currentProgram->MarkAllUniformsDirty();
+        SetUniforms(m_encoder, *m_currentProgram, false);
+
+        // Texture bindings are kept for the draws that follow; the compute bindings are replaced below.
+        m_encoder->dispatch(viewId, m_currentProgram->Program, numX, numY, numZ, BGFX_DISCARD_ALL & ~BGFX_DISCARD_BINDINGS);
+
+        for (const uint8_t stage : m_computeStages)
+        {
+            const auto binding = m_textureBindings.find(stage);
+            if (binding != m_textureBindings.end() && binding->second.Texture != bgfx::kInvalidHandle)
+            {
+                m_encoder->setTexture(stage, bgfx::UniformHandle{binding->second.Uniform}, bgfx::TextureHandle{binding->second.Texture}, binding->second.Flags);
+            }
+        }
+        m_computeStages.clear();
+
+        // The values bgfx last saw for uniforms shared with draw programs are the compute program's.
+        m_lastUniformSubmitState = {};
+    }
+
     Napi::Value NativeEngine::GetAttributes(const Napi::CallbackInfo& info)
     {
         const auto program = info[0].As<Napi::External<ProgramData>>().Data();
@@ -799,17 +1593,116 @@ namespace Babylon
         return std::move(attributes);
     }
 
+    Napi::Value NativeEngine::GetUniformSlots(const Napi::CallbackInfo& info)
+    {
+        const auto program = info[0].As<Napi::External<ProgramData>>().Data();
+        auto nameHashes = info[1].As<Napi::Uint32Array>();
+
+        const auto length = nameHashes.ElementLength();
+        auto slots = Napi::Int32Array::New(info.Env(), length);
+        for (size_t index = 0; index < length; ++index)
+        {
+            slots[index] = program->FindReflectedUniform(nameHashes[index]);
+        }
+
+        return std::move(slots);
+    }
+
+    Napi::Value NativeEngine::GetAttributeLocations(const Napi::CallbackInfo& info)
+    {
+        const auto program = info[0].As<Napi::External<ProgramData>>().Data();
+        auto nameHashes = info[1].As<Napi::Uint32Array>();
+
+        const auto length = nameHashes.ElementLength();
+        auto locations = Napi::Int32Array::New(info.Env(), length);
+        for (size_t index = 0; index < length; ++index)
+        {
+            locations[index] = program->FindReflectedAttribute(nameHashes[index]);
+        }
+
+        return std::move(locations);
+    }
+
+    const UniformInfo* NativeEngine::GetUniformInfo(const Napi::Value& value) const
+    {
+        // Uniforms are passed either as the externals returned by getUniforms or as the reflection slots
+        // returned by getUniformSlots, which refer to the current program.
+        if (value.IsNumber())
+        {
+            const auto slot = value.As<Napi::Number>().Uint32Value();
+            if (m_currentProgram == nullptr || slot >= m_currentProgram->ReflectedUniforms.size())
+            {
+                throw std::runtime_error{"Uniform slot is out of range for the current program."};
+            }
+
+            return m_currentProgram->ReflectedUniforms[slot];
+        }
+
+        return value.As<Napi::External<UniformInfo>>().Data();
+    }
+
+    Napi::Value NativeEngine::GetUniformOffsets(const Napi::CallbackInfo& info)
+    {
+        const auto program = info[0].As<Napi::External<ProgramData>>().Data();
+        const auto names = info[1].As<Napi::Array>();
+
+        const auto length = names.Length();
+        auto offsets = Napi::Int32Array::New(info.Env(), length);
+        for (uint32_t index = 0; index < length; ++index)
+        {
+            const auto name = names[index].As<Napi::String>().Utf8Value();
+
+            uint16_t slot{UniformInfo::kInvalidSlot};
+            auto vertexFound = program->VertexUniformInfos.find(name);
+            auto fragmentFound = program->FragmentUniformInfos.find(name);
+
+            if (vertexFound != program->VertexUniformInfos.end())
+            {
+                slot = vertexFound->second.Slot;
+            }
+            else if (fragmentFound != program->FragmentUniformInfos.end())
+            {
+                slot = fragmentFound->second.Slot;
+            }
+
+            offsets[index] = (slot == UniformInfo::kInvalidSlot ? -1 : gsl::narrow_cast<int32_t>(program->Uniforms[slot].Offset));
+        }
+
+        return std::move(offsets);
+    }
+
+    void NativeEngine::SetUniformBlock(const Napi::CallbackInfo& info)
+    {
+        const auto program = info[0].As<Napi::External<ProgramData>>().Data();
+        const auto data = info[1].As<Napi::Float32Array>();
+        const auto offset = info[2].IsUndefined() ? 0 : info[2].As<Napi::Number>().Uint32Value();
+
+        program->SetUniformBlock(gsl::make_span(data.Data(), data.ElementLength()), offset, [this, program](uint16_t slot) {
+            FlushBeforeUniformChange(*program, slot);
+        });
+    }
+
     void NativeEngine::SetProgram(const Napi::CallbackInfo& info)
     {
-        auto program = info[0].As<Napi::External<ProgramData>>().Data();
+        SetProgram(info[0].As<Napi::External<ProgramData>>().Data());
+    }
+
+    void NativeEngine::SetProgram(ProgramData* program)
+    {
         m_currentProgram = program;
     }
 
     void NativeEngine::SetState(const Napi::CallbackInfo& info)
     {
         const auto culling = info[0].As<Napi::Boolean>().Value();
+        const auto zOffset = info[1].As<Napi::Number>().FloatValue();
         const auto reverseSide = info[2].As<Napi::Boolean>().Value();
 
+        SetState(culling, zOffset, reverseSide);
+    }
+
+    void NativeEngine::SetState(bool culling, float /*zOffset*/, bool reverseSide)
+    {
         m_engineState &= ~BGFX_STATE_CULL_MASK;
         if (reverseSide)
         {
@@ -831,7 +1724,6 @@ namespace Babylon
         }
 
         // TODO: zOffset
-        //const auto zOffset = info[1].As<Napi::Number>().FloatValue();
     }
 
     void NativeEngine::SetZOffset(const Napi::CallbackInfo& /*info*/)
@@ -849,8 +1741,11 @@ namespace Babylon
 
     void NativeEngine::SetDepthTest(const Napi::CallbackInfo& info)
     {
-        const auto depthTest = info[0].As<Napi::Number>().Uint32Value();
+        SetDepthTest(info[0].As<Napi::Number>().Uint32Value());
+    }
 
+    void NativeEngine::SetDepthTest(uint32_t depthTest)
+    {
         m_engineState &= ~BGFX_STATE_DEPTH_TEST_MASK;
         m_engineState |= depthTest;
     }
@@ -862,62 +1757,85 @@ namespace Babylon
 
     void NativeEngine::SetDepthWrite(const Napi::CallbackInfo& info)
     {
-        const auto enable = info[0].As<Napi::Boolean>().Value();
+        SetDepthWrite(info[0].As<Napi::Boolean>().Value());
+    }
 
+    void NativeEngine::SetDepthWrite(bool enable)
+    {
         m_engineState &= ~BGFX_STATE_WRITE_Z;
         m_engineState |= enable ? BGFX_STATE_WRITE_Z : 0;
     }
 
     void NativeEngine::SetColorWrite(const Napi::CallbackInfo& info)
     {
-        const auto enable = info[0].As<Napi::Boolean>().Value();
+        SetColorWrite(info[0].As<Napi::Boolean>().Value());
+    }
 
+    void NativeEngine::SetColorWrite(bool enable)
+    {
         m_engineState &= ~(BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A);
         m_engineState |= enable ? (BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A) : 0;
     }
 
     void NativeEngine::SetBlendMode(const Napi::CallbackInfo& info)
     {
-        const auto blendMode = info[0].As<Napi::Number>().Int64Value();
+        SetBlendMode(static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value()));
+    }
 
+    void NativeEngine::SetBlendMode(uint64_t blendMode)
+    {
         m_engineState &= ~BGFX_STATE_BLEND_MASK;
         m_engineState |= blendMode;
     }
 
     void NativeEngine::SetInt(const Napi::CallbackInfo& info)
     {
-        const auto uniformInfo = info[0].As<Napi::External<UniformInfo>>().Data();
-        const auto value = info[1].As<Napi::Number>().FloatValue();
-        m_currentProgram->SetUniform(uniformInfo->Handle, gsl::make_span(&value, 1), uniformInfo->YFlip);
+        const auto uniformInfo = GetUniformInfo(info[0]);
+        const auto value = info[1].As<Napi::Number>().Int32Value();
+        SetInt(uniformInfo, value);
+    }
+
+    void NativeEngine::SetInt(const UniformInfo* uniformInfo, int32_t value)
+    {
+        const auto floatValue = static_cast<float>(value);
+        SetProgramUniform(*uniformInfo, gsl::make_span(&floatValue, 1));
     }
 
     template<int size, typename arrayType>
     void NativeEngine::SetTypeArrayN(const Napi::CallbackInfo& info)
     {
-        const auto uniformInfo = info[0].As<Napi::External<UniformInfo>>().Data();
+        const auto uniformInfo = GetUniformInfo(info[0]);
         const auto array = info[1].As<arrayType>();
+        const auto* data = array.Data();
+
+        SetTypeArrayN<size>(uniformInfo, gsl::make_span(data, array.ElementLength()));
+    }
 
-        size_t elementLength = array.ElementLength();
+    template<int size, typename ElementT>
+    void NativeEngine::SetTypeArrayN(const UniformInfo* uniformInfo, gsl::span<const ElementT> array)
+    {
+        const auto componentCount = static_cast<size_t>(array.size());
+        const auto elementCount = (componentCount + size - 1) / size;
 
-        m_scratch.clear();
-        for (size_t index = 0; index < elementLength; index += size)
+        if constexpr (size == 4 && std::is_same_v<ElementT, float>)
         {
-            const float values[] = {
-                static_cast<float>(array[index]),
-                (size > 1) ? static_cast<float>(array[index + 1]) : 0.f,
-                (size > 2) ? static_cast<float>(array[index + 2]) : 0.f,
-                (size > 3) ? static_cast<float>(array[index + 3]) : 0.f,
-            };
-            m_scratch.insert(m_scratch.end(), values, values + 4);
+            if (componentCount % 4 == 0)
+            {
+                // Already laid out as vec4s, so the values go straight from the array into the program's uniform data.
+                SetProgramUniform(*uniformInfo, array, elementCount);
+                return;
+            }
         }
 
-        m_currentProgram->SetUniform(uniformInfo->Handle, m_scratch, uniformInfo->YFlip, elementLength / size);
+        m_scratch.resize(elementCount);
+        UniformArrays::WidenToVec4<size>(array.data(), componentCount, m_scratch.data());
+        SetProgramUniform(*uniformInfo, gsl::make_span(reinterpret_cast<const float*>(m_scratch.data()), elementCount * 4), elementCount);
     }
 
     template<int size>
     void NativeEngine::SetFloatN(const Napi::CallbackInfo& info)
     {
-        const auto uniformInfo = info[0].As<Napi::External<UniformInfo>>().Data();
+        const auto uniformInfo = GetUniformInfo(info[0]);
         const float values[] = {
             info[1].As<Napi::Number>().FloatValue(),
             (size > 1) ? info[2].As<Napi::Number>().FloatValue() : 0.f,
@@ -925,17 +1843,32 @@ namespace Babylon
             (size > 3) ? info[4].As<Napi::Number>().FloatValue() : 0.f,
         };
 
-        m_currentProgram->SetUniform(uniformInfo->Handle, values, uniformInfo->YFlip);
+        SetFloatN<size>(uniformInfo, values);
+    }
+
+    template<int size>
+    void NativeEngine::SetFloatN(const UniformInfo* uniformInfo, const float (&values)[4])
+    {
+        SetProgramUniform(*uniformInfo, values);
     }
 
     template<int size>
     void NativeEngine::SetMatrixN(const Napi::CallbackInfo& info)
     {
-        const auto uniformInfo = info[0].As<Napi::External<UniformInfo>>().Data();
+        const auto uniformInfo = GetUniformInfo(info[0]);
         const auto matrix = info[1].As<Napi::Float32Array>();
 
-        const size_t elementLength = matrix.ElementLength();
-        assert(elementLength == size * size);
+        SetMatrixN<size>(uniformInfo, gsl::make_span(matrix.Data(), matrix.ElementLength()));
+    }
+
+    template<int size>
+    void NativeEngine::SetMatrixN(const UniformInfo* uniformInfo, gsl::span<const float> matrix)
+    {
+        // The values are read as a whole matrix, and can come from the command stream as well as JavaScript.
+        if (static_cast<size_t>(matrix.size()) != size * size)
+        {
+            throw std::runtime_error{"Matrix uniform has the wrong number of values."};
+        }
 
         if constexpr (size < 4)
         {
@@ -950,11 +1883,11 @@ namespace Babylon
                 }
             }
 
-            m_currentProgram->SetUniform(uniformInfo->Handle, gsl::make_span(matrixValues.data(), 16), uniformInfo->YFlip);
+            SetProgramUniform(*uniformInfo, gsl::make_span(matrixValues.data(), 16));
         }
         else
         {
-            m_currentProgram->SetUniform(uniformInfo->Handle, gsl::make_span(matrix.Data(), elementLength), uniformInfo->YFlip);
+            SetProgramUniform(*uniformInfo, matrix);
         }
     }
 
@@ -1000,13 +1933,34 @@ namespace Babylon
 
     void NativeEngine::SetMatrices(const Napi::CallbackInfo& info)
     {
-        const auto uniformInfo = info[0].As<Napi::External<UniformInfo>>().Data();
+        const auto uniformInfo = GetUniformInfo(info[0]);
         const auto matricesArray = info[1].As<Napi::Float32Array>();
 
-        const size_t elementLength = matricesArray.ElementLength();
+        SetMatrices(uniformInfo, gsl::make_span(matricesArray.Data(), matricesArray.ElementLength()));
+    }
+
+    void NativeEngine::SetMatrices(const UniformInfo* uniformInfo, gsl::span<const float> matrices)
+    {
+        const auto elementLength = static_cast<size_t>(matrices.size());
         assert(elementLength % 16 == 0);
 
-        m_currentProgram->SetUniform(uniformInfo->Handle, gsl::span(matricesArray.Data(), elementLength), uniformInfo->YFlip, elementLength / 16);
+        SetProgramUniform(*uniformInfo, matrices, elementLength / 16);
+    }
+
+    void NativeEngine::ComposeWorldMatrices(const Napi::CallbackInfo& info)
+    {
+        const auto translations = info[0].As<Napi::Float32Array>();
+        const auto rotations = info[1].As<Napi::Float32Array>();
+        const auto scalings = info[2].As<Napi::Float32Array>();
+        const auto parents = info[3].As<Napi::Int32Array>();
+        auto worlds = info[4].As<Napi::Float32Array>();
+
+        WorldMatrices::Compose(
+            gsl::make_span(translations.Data(), translations.ElementLength()),
+            gsl::make_span(rotations.Data(), rotations.ElementLength()),
+            gsl::make_span(scalings.Data(), scalings.ElementLength()),
+            gsl::make_span(parents.Data(), parents.ElementLength()),
+            gsl::make_span(worlds.Data(), worlds.ElementLength()));
     }
 
     void NativeEngine::SetMatrix2x2(const Napi::CallbackInfo& info)
@@ -1065,7 +2019,9 @@ namespace Babylon
 
         texture->Handle = bgfx::getTexture(frameBufferHandle);
 
-        return Napi::External<FrameBufferData>::New(info.Env(), m_frameBufferManager.CreateNew(frameBufferHandle, width, height));
+        FrameBufferData* frameBufferData = m_frameBufferManager.CreateNew(frameBufferHandle, width, height);
+        frameBufferData->Tracked.Track(ResourceType::FrameBuffer, TextureBytes(width, height, false, depthStencilFormat));
+        return Napi::External<FrameBufferData>::New(info.Env(), frameBufferData);
     }
 
     void NativeEngine::LoadTexture(const Napi::CallbackInfo& info)
@@ -1076,28 +2032,50 @@ namespace Babylon
         const auto invertY = info[3].As<Napi::Boolean>().Value();
         const auto onSuccess = info[4].As<Napi::Function>();
         const auto onError = info[5].As<Napi::Function>();
+        const auto stream = info.Length() > 6 && info[6].ToBoolean().Value();
+        const auto srgb = info.Length() > 7 && info[7].ToBoolean().Value();
+
+        // The GPU filters in whatever space the texture is stored in, so sRGB images keep their mips from the CPU.
+        const auto gpuMips = m_gpuMipGeneration && generateMips && !stream && !srgb;
 
         const auto dataSpan = gsl::make_span(static_cast<uint8_t*>(data.ArrayBuffer().Data()) + data.ByteOffset(), data.ByteLength());
 
         arcana::make_task(arcana::threadpool_scheduler, m_cancelSource,
-            [this, dataSpan, generateMips, invertY]() {
-                bimg::ImageContainer* image = bimg::imageParse(&m_allocator, dataSpan.data(), static_cast<uint32_t>(dataSpan.size()));
-                if (image == nullptr)
-                {
-                    throw std::runtime_error("Unable to decode image."); // exeption will be forwarded to JS
-                }
-                if (invertY)
+            [this, dataSpan, generateMips, invertY, srgb, gpuMips]() {
+                bimg::ImageContainer* image = ParseImage(&m_allocator, dataSpan);
+                try
                 {
-                    FlipY(image);
+                    if (invertY)
+                    {
+                        ImageProcessing::FlipY(*image);
+                    }
+                    if (generateMips && !(gpuMips && !image->m_srgb && CanGenerateMipsOnGpu(*image)))
+                    {
+                        ImageProcessing::GenerateMips(&m_allocator, &image, srgb);
+                    }
                 }
-                if (generateMips)
+                catch (...)
                 {
-                    GenerateMips(&m_allocator, &image);
+                    bimg::imageFree(image);
+                    throw;
                 }
                 return image;
             })
-            .then(RuntimeScheduler, m_cancelSource, [texture, dataRef = Napi::Persistent(data)](bimg::ImageContainer* image) {
-                CreateTextureFromImage(texture, image);
+            .then(RuntimeScheduler, m_cancelSource, [this, texture, stream, gpuMips, dataRef = Napi::Persistent(data)](bimg::ImageContainer* image) {
+                if (stream && TextureStreamer::CanStream(*image))
+                {
+                    m_textureStreamer.Start(*texture, image);
+                }
+                else if (gpuMips && !image->m_srgb && image->m_numMips == 1 && CanGenerateMipsOnGpu(*image))
+                {
+                    m_textureStreamer.Cancel(*texture);
+                    CreateTextureWithGpuMips(texture, image);
+                }
+                else
+                {
+                    m_textureStreamer.Cancel(*texture);
+                    CreateTextureFromImage(texture, image);
+                }
             })
             .then(arcana::inline_scheduler, m_cancelSource, [onSuccessRef = Napi::Persistent(onSuccess), onErrorRef = Napi::Persistent(onError)](arcana::expected<void, std::exception_ptr> result) {
                 if (result.has_error())
@@ -1125,10 +2103,10 @@ namespace Babylon
             const auto typedArray = data[face].As<Napi::TypedArray>();
             const auto dataSpan = gsl::make_span(static_cast<uint8_t*>(typedArray.ArrayBuffer().Data()) + typedArray.ByteOffset(), typedArray.ByteLength());
             tasks[face] = arcana::make_task(arcana::threadpool_scheduler, m_cancelSource, [this, dataSpan, generateMips]() {
-                bimg::ImageContainer* image = bimg::imageParse(&m_allocator, dataSpan.data(), static_cast<uint32_t>(dataSpan.size()));
+                bimg::ImageContainer* image = ParseImage(&m_allocator, dataSpan);
                 if (generateMips)
                 {
-                    GenerateMips(&m_allocator, &image);
+                    ImageProcessing::GenerateMips(&m_allocator, &image);
                 }
                 return image;
             });
@@ -1136,8 +2114,9 @@ namespace Babylon
 
         arcana::when_all(gsl::make_span(tasks))
             .then(RuntimeScheduler, m_cancelSource,
-                [texture, dataRef = Napi::Persistent(data), generateMips](const std::vector<bimg::ImageContainer*>& images) {
-                    CreateCubeTextureFromImages(texture, images, generateMips);
+                [texture, dataRef = Napi::Persistent(data)](const std::vector<bimg::ImageContainer*>& images) {
+                    // KTX2 faces can bring their own mips.
+                    CreateCubeTextureFromImages(texture, images, images.front()->m_numMips > 1);
                 })
             .then(arcana::inline_scheduler, m_cancelSource, [this, onSuccessRef = Napi::Persistent(onSuccess)]() {
                 onSuccessRef.Call({Napi::Value::From(Env(), true)});
@@ -1167,8 +2146,16 @@ namespace Babylon
                 const auto typedArray = faceData[face].As<Napi::TypedArray>();
                 const auto dataSpan = gsl::make_span(static_cast<uint8_t*>(typedArray.ArrayBuffer().Data()) + typedArray.ByteOffset(), typedArray.ByteLength());
                 tasks[(face * numMips) + mip] = arcana::make_task(arcana::threadpool_scheduler, m_cancelSource, [this, dataSpan]() {
-                    bimg::ImageContainer* image = bimg::imageParse(&m_allocator, dataSpan.data(), static_cast<uint32_t>(dataSpan.size()));
-                    FlipY(image);
+                    bimg::ImageContainer* image = ParseImage(&m_allocator, dataSpan);
+                    try
+                    {
+                        ImageProcessing::FlipY(*image);
+                    }
+                    catch (...)
+                    {
+                        bimg::imageFree(image);
+                        throw;
+                    }
                     return image;
                 });
             }
@@ -1204,8 +2191,13 @@ namespace Babylon
     void NativeEngine::SetTextureSampling(const Napi::CallbackInfo& info)
     {
         const auto texture = info[0].As<Napi::External<TextureData>>().Data();
-        auto filter = static_cast<uint32_t>(info[1].As<Napi::Number>().Uint32Value());
+        const auto filter = info[1].As<Napi::Number>().Uint32Value();
 
+        SetTextureSampling(texture, filter);
+    }
+
+    void NativeEngine::SetTextureSampling(TextureData* texture, uint32_t filter)
+    {
         texture->Flags &= ~(BGFX_SAMPLER_MIN_MASK | BGFX_SAMPLER_MAG_MASK | BGFX_SAMPLER_MIP_MASK);
 
         if (texture->AnisotropicLevel > 1)
@@ -1225,6 +2217,11 @@ namespace Babylon
         auto addressModeV = static_cast<uint32_t>(info[2].As<Napi::Number>().Uint32Value());
         auto addressModeW = static_cast<uint32_t>(info[3].As<Napi::Number>().Uint32Value());
 
+        SetTextureWrapMode(texture, addressModeU, addressModeV, addressModeW);
+    }
+
+    void NativeEngine::SetTextureWrapMode(TextureData* texture, uint32_t addressModeU, uint32_t addressModeV, uint32_t addressModeW)
+    {
         uint32_t addressMode = addressModeU +
             (addressModeV << BGFX_SAMPLER_V_SHIFT) +
             (addressModeW << BGFX_SAMPLER_W_SHIFT);
@@ -1238,6 +2235,11 @@ namespace Babylon
         const auto texture = info[0].As<Napi::External<TextureData>>().Data();
         const auto value = info[1].As<Napi::Number>().Uint32Value();
 
+        SetTextureAnisotropicLevel(texture, value);
+    }
+
+    void NativeEngine::SetTextureAnisotropicLevel(TextureData* texture, uint32_t value)
+    {
         texture->AnisotropicLevel = static_cast<uint8_t>(value);
 
         // if Anisotropic is set to 0 after being >1, then set texture flags back to linear
@@ -1250,18 +2252,113 @@ namespace Babylon
 
     void NativeEngine::SetTexture(const Napi::CallbackInfo& info)
     {
-        const auto uniformInfo = info[0].As<Napi::External<UniformInfo>>().Data();
+        const auto uniformInfo = GetUniformInfo(info[0]);
         const auto texture = info[1].As<Napi::External<TextureData>>().Data();
 
-        bgfx::setTexture(uniformInfo->Stage, uniformInfo->Handle, texture->Handle, texture->Flags);
+        SetTexture(uniformInfo, texture);
+    }
+
+    void NativeEngine::SetTexture(const UniformInfo* uniformInfo, const TextureData* texture)
+    {
+        // Texture bindings are kept between submits, so changing one must not happen while a draw is held back.
+        const TextureBinding binding{uniformInfo->Handle.idx, texture->Handle.idx, texture->Flags};
+        auto& currentBinding = m_textureBindings[uniformInfo->Stage];
+        if (binding != currentBinding)
+        {
+            FlushPendingDraw();
+            m_textureBindingsKey ^= HashTextureBinding(uniformInfo->Stage, currentBinding.Uniform, currentBinding.Texture, currentBinding.Flags);
+            m_textureBindingsKey ^= HashTextureBinding(uniformInfo->Stage, binding.Uniform, binding.Texture, binding.Flags);
+            currentBinding = binding;
+        }
+
+        m_encoder->setTexture(uniformInfo->Stage, uniformInfo->Handle, texture->Handle, texture->Flags);
     }
 
     void NativeEngine::DeleteTexture(const Napi::CallbackInfo& info)
     {
         const auto texture = info[0].As<Napi::External<TextureData>>().Data();
+        FlushPendingDraw();
+        m_textureStreamer.Cancel(*texture);
+        ForgetTextureBindings(texture->Handle);
         delete texture;
     }
 
+    void NativeEngine::ForgetTextureBindings(bgfx::TextureHandle handle)
+    {
+        // The handle may be reused by a later texture, so bindings to this one must not match it.
+        for (auto& [stage, binding] : m_textureBindings)
+        {
+            if (binding.Texture == handle.idx)
+            {
+                m_textureBindingsKey ^= HashTextureBinding(stage, binding.Uniform, binding.Texture, binding.Flags);
+                binding = {};
+                m_textureBindingsKey ^= HashTextureBinding(stage, binding.Uniform, binding.Texture, binding.Flags);
+            }
+        }
+    }
+
+    void NativeEngine::SetTextureStreamingBudget(const Napi::CallbackInfo& info)
+    {
+        m_textureStreamer.SetFrameBudget(info[0].As<Napi::Number>().Uint32Value());
+    }
+
+    void NativeEngine::SetGpuMipGenerationEnabled(const Napi::CallbackInfo& info)
+    {
+        m_gpuMipGeneration = info[0].As<Napi::Boolean>().Value();
+    }
+
+    void NativeEngine::CreateTextureWithGpuMips(TextureData* texture, bimg::ImageContainer* image)
+    {
+        const auto width = static_cast<uint16_t>(image->m_width);
+        const auto height = static_cast<uint16_t>(image->m_height);
+        const auto format = Cast(image->m_format);
+
+        // Created without data so that the base mip can be uploaded on its own; the other mips are rendered.
+        texture->Handle = bgfx::createTexture2D(width, height, true, 1, format, BGFX_TEXTURE_RT | BGFX_SAMPLER_NONE);
+        bgfx::updateTexture2D(texture->Handle, 0, 0, 0, 0, width, height, bgfx::makeRef(image->m_data, image->m_size, ReleaseImage, image));
+        texture->Width = width;
+        texture->Height = height;
+        texture->Tracked.Track(ResourceType::Texture, TextureBytes(width, height, true, format));
+
+        // The frame buffer holds a reference to the texture, so the texture can be deleted before its mips are made.
+        bgfx::Attachment attachment{};
+        attachment.init(texture->Handle);
+        m_mipGenerationQueue.push_back({bgfx::createFrameBuffer(1, &attachment, false), width, height});
+    }
+
+    void NativeEngine::GenerateQueuedMips()
+    {
+        if (m_mipGenerationQueue.empty())
+        {
+            return;
+        }
+
+        auto it = m_mipGenerationQueue.begin();
+        for (; it != m_mipGenerationQueue.end(); ++it)
+        {
+            const auto viewId = m_frameBufferManager.AcquireSpareViewId();
+            if (!viewId)
+            {
+                break;
+            }
+
+            bgfx::setViewName(*viewId, "Mip generation");
+            bgfx::setViewFrameBuffer(*viewId, it->FrameBuffer);
+            bgfx::setViewRect(*viewId, 0, 0, it->Width, it->Height);
+            bgfx::setViewClear(*viewId, BGFX_CLEAR_NONE);
+            bgfx::setViewMode(*viewId, bgfx::ViewMode::Default);
+            bgfx::touch(*viewId);
+
+            // bgfx keeps the frame buffer until the frame that uses it has been rendered.
+            bgfx::destroy(it->FrameBuffer);
+        }
+        m_mipGenerationQueue.erase(m_mipGenerationQueue.begin(), it);
+
+        // The bound frame buffer may still hold one of the view ids just taken.
+        FlushPendingDraw();
+        m_frameBufferManager.Bind(&m_frameBufferManager.GetBound());
+    }
+
     Napi::Value NativeEngine::CreateFrameBuffer(const Napi::CallbackInfo& info)
     {
         const auto texture = info[0].As<Napi::External<TextureData>>().Data();
@@ -1271,16 +2368,22 @@ namespace Babylon
         //int samplingMode = info[4].As<Napi::Number>().Uint32Value();
         bool generateStencilBuffer = info[5].As<Napi::Boolean>();
         bool generateDepth = info[6].As<Napi::Boolean>();
-        bool generateMips = info[7].As<Napi::Boolean>();
+        // bgfx regenerates the mips of a frame buffer's textures on the GPU each time the view rendering to it is
+        // resolved, which happens once the frame buffer is unbound and another view is rendered. Formats it cannot
+        // generate mips for get none rather than mips that are never filled in.
+        bool generateMips = info[7].As<Napi::Boolean>() && CanGenerateMipsOnGpu(format);
 
         bgfx::FrameBufferHandle frameBufferHandle{};
+        uint64_t frameBufferBytes{TextureBytes(width, height, generateMips, format)};
         if (generateStencilBuffer && !generateDepth)
         {
             throw std::exception{/* Does this case even make any sense? */};
         }
         else if (!generateStencilBuffer && !generateDepth)
         {
-            frameBufferHandle = bgfx::createFrameBuffer(width, height, format, BGFX_TEXTURE_RT);
+            bgfx::Attachment attachment{};
+            attachment.init(bgfx::createTexture2D(width, height, generateMips, 1, format, BGFX_TEXTURE_RT));
+            frameBufferHandle = bgfx::createFrameBuffer(1, &attachment, true);
         }
         else
         {
@@ -1295,49 +2398,77 @@ namespace Babylon
 
             std::array<bgfx::TextureHandle, 2> textures{
                 bgfx::createTexture2D(width, height, generateMips, 1, format, BGFX_TEXTURE_RT),
-                bgfx::createTexture2D(width, height, generateMips, 1, depthStencilFormat, BGFX_TEXTURE_RT)};
+                bgfx::createTexture2D(width, height, false, 1, depthStencilFormat, BGFX_TEXTURE_RT)};
             std::array<bgfx::Attachment, textures.size()> attachments{};
             for (size_t idx = 0; idx < attachments.size(); ++idx)
             {
                 attachments[idx].init(textures[idx]);
             }
             frameBufferHandle = bgfx::createFrameBuffer(static_cast<uint8_t>(attachments.size()), attachments.data(), true);
+            frameBufferBytes += TextureBytes(width, height, false, depthStencilFormat);
         }
 
         texture->Handle = bgfx::getTexture(frameBufferHandle);
 
-        return Napi::External<FrameBufferData>::New(info.Env(), m_frameBufferManager.CreateNew(frameBufferHandle, width, height));
+        FrameBufferData* frameBufferData = m_frameBufferManager.CreateNew(frameBufferHandle, width, height);
+        frameBufferData->Tracked.Track(ResourceType::FrameBuffer, frameBufferBytes);
+        return Napi::External<FrameBufferData>::New(info.Env(), frameBufferData);
     }
 
     void NativeEngine::DeleteFrameBuffer(const Napi::CallbackInfo& info)
     {
         const auto frameBufferData = info[0].As<Napi::External<FrameBufferData>>().Data();
+        FlushPendingDraw();
         delete frameBufferData;
     }
 
     void NativeEngine::BindFrameBuffer(const Napi::CallbackInfo& info)
     {
-        const auto frameBufferData = info[0].As<Napi::External<FrameBufferData>>().Data();
+        BindFrameBuffer(info[0].As<Napi::External<FrameBufferData>>().Data());
+    }
+
+    void NativeEngine::BindFrameBuffer(FrameBufferData* frameBufferData)
+    {
+        // Setting up a view discards the state recorded for a held back draw.
+        FlushPendingDraw();
         m_frameBufferManager.Bind(frameBufferData);
     }
 
     void NativeEngine::UnbindFrameBuffer(const Napi::CallbackInfo& info)
     {
-        const auto frameBufferData = info[0].As<Napi::External<FrameBufferData>>().Data();
+        UnbindFrameBuffer(info[0].As<Napi::External<FrameBufferData>>().Data());
+    }
+
+    void NativeEngine::UnbindFrameBuffer(FrameBufferData* frameBufferData)
+    {
+        FlushPendingDraw();
         m_frameBufferManager.Unbind(frameBufferData);
     }
 
     void NativeEngine::DrawIndexed(const Napi::CallbackInfo& info)
     {
         const auto fillMode = info[0].As<Napi::Number>().Int32Value();
-        const auto elementStart = info[1].As<Napi::Number>().Int32Value();
-        const auto elementCount = info[2].As<Napi::Number>().Int32Value();
-        // TODO: handle viewport
+        const auto elementStart = info[1].As<Napi::Number>().Uint32Value();
+        const auto elementCount = info[2].As<Napi::Number>().Uint32Value();
 
-        if (m_currentBoundIndexBuffer)
-        {
-            m_currentBoundIndexBuffer->SetBgfxIndexBuffer(elementStart, elementCount);
-        }
+        DrawIndexed(fillMode, elementStart, elementCount);
+    }
+
+    void NativeEngine::DrawIndexedInstanced(const Napi::CallbackInfo& info)
+    {
+        const auto fillMode = info[0].As<Napi::Number>().Int32Value();
+        const auto elementStart = info[1].As<Napi::Number>().Uint32Value();
+        const auto elementCount = info[2].As<Napi::Number>().Uint32Value();
+        const auto instanceBufferData = info[3].As<Napi::External<InstanceBufferData>>().Data();
+        const auto instanceStart = info[4].As<Napi::Number>().Uint32Value();
+        const auto instanceCount = info[5].As<Napi::Number>().Uint32Value();
+
+        DrawIndexed(fillMode, elementStart, elementCount, instanceBufferData, instanceStart, instanceCount);
+    }
+
+    void NativeEngine::DrawIndexed(int32_t fillMode, uint32_t elementStart, uint32_t elementCount, const InstanceBufferData* instanceBufferData, uint32_t instanceStart, uint32_t instanceCount)
+    {
+        // TODO: handle viewport
 
         // TODO: support other fill modes
         uint64_t fillModeState = 0; //indexed tri list
@@ -1357,88 +2488,565 @@ namespace Babylon
                 break;
         }
 
-        if (m_frameBufferManager.IsRenderingToTarget() && (!bgfx::getCaps()->originBottomLeft))
-        {
-            // UV coordinates system are different between OpenGL and Direct3D/Metal
-            // This is not an issue with loaded textures (png/jpg...) because
-            // texel rows bytes are also using a different convention
-            // see https://www.puredevsoftware.com/blog/2018/03/17/texture-coordinates-d3d-vs-opengl/
-            // for render to texture, as the texel bytes are not reversed, sampling a RTT for
-            // post process or shadows will result in inversion on V axis (Y)
-            // to compensate for that, any matrix that is used to project onto clip-space has
-            // to be flipped.
-            // The involved matrices are determined by name and a boolean YFlip is set to true.
-            // When rendering to texture, those matrices are flipped and set as uniform datas.
-            // But because flipping clip-space coordinates also flips triangles winding,
-            // Culling also has to be flipped.
-            for (const auto& it : m_currentProgram->Uniforms)
-            {
-                const ProgramData::UniformValue& value = it.second;
-                if (value.YFlip)
-                {
-                    float tmpMatrix[16];
-                    static const float flipMatrix[16] = {1.f, 0.f, 0.f, 0.f,
-                        0.f, -1.f, 0.f, 0.f,
-                        0.f, 0.f, 1.f, 0.f,
-                        0.f, 0.f, 0.f, 1.f};
-                    bx::mtxMul(tmpMatrix, value.Data.data(), flipMatrix);
-                    bgfx::setUniform({it.first}, tmpMatrix, value.ElementLength);
+        // UV coordinates system are different between OpenGL and Direct3D/Metal
+        // This is not an issue with loaded textures (png/jpg...) because
+        // texel rows bytes are also using a different convention
+        // see https://www.puredevsoftware.com/blog/2018/03/17/texture-coordinates-d3d-vs-opengl/
+        // for render to texture, as the texel bytes are not reversed, sampling a RTT for
+        // post process or shadows will result in inversion on V axis (Y)
+        // to compensate for that, any matrix that is used to project onto clip-space has
+        // to be flipped.
+        // The involved matrices are determined by name and a boolean YFlip is set to true.
+        // Flipped copies of those matrices are kept by the program and set instead when rendering to texture.
+        // But because flipping clip-space coordinates also flips triangles winding,
+        // Culling also has to be flipped.
+        const bool yFlip = m_frameBufferManager.IsRenderingToTarget() && (!bgfx::getCaps()->originBottomLeft);
+
+        uint64_t state = m_engineState | fillModeState;
+        if (yFlip)
+        {
+            // change culling
+            if (m_engineState & ~BGFX_STATE_CULL_MASK)
+            {
+                state ^= BGFX_STATE_CULL_MASK;
+            }
+        }
+
+        const FrameBufferData& frameBuffer = m_frameBufferManager.GetBound();
+        const bgfx::ViewId viewId = frameBuffer.ViewId;
+        m_frameBufferManager.MarkViewUsed(viewId);
+
+        // The sort depth orders draws with the same program within a view. Blended draws keep submission order.
+        const bool autoSorted = frameBuffer.SortMode == ViewSortMode::Auto && (state & BGFX_STATE_BLEND_MASK) == 0;
+        const uint32_t sortDepth = autoSorted ? m_textureBindingsKey : 0;
+
+        // bgfx keeps the last value set for each uniform and draws sharing a view, program and state keep their
+        // submission order, so a draw identical in those respects to the previous one only needs the uniforms
+        // that changed since. Anything else may be reordered relative to the previous draw and sets everything.
+        const UniformSubmitState submitState{m_currentProgram, m_currentProgram->Program.idx, viewId, state, sortDepth, yFlip};
+        const bool autoInstancing = (instanceBufferData == nullptr) && !bgfx::isValid(m_activeOcclusionQuery) && bgfx::isValid(m_currentProgram->InstancedProgram);
+
+        if (m_pendingDraw.Program != nullptr)
+        {
+            // A draw that only differs from the pending one by its world matrix becomes another instance of it.
+            if (autoInstancing &&
+                submitState == m_pendingDraw.SubmitState &&
+                m_currentVertexArray == m_pendingDraw.BoundVertexArray &&
+                m_currentBoundIndexBuffer == m_pendingDraw.BoundIndexBuffer &&
+                elementStart == m_pendingDraw.ElementStart &&
+                elementCount == m_pendingDraw.ElementCount &&
+                !m_currentProgram->HasDirtyUniformsOtherThan(m_currentProgram->WorldSlot))
+            {
+                auto& world = m_currentProgram->Uniforms[m_currentProgram->WorldSlot];
+                const float* worldData = m_currentProgram->GetUniformData(world);
+                m_pendingDraw.WorldMatrices.insert(m_pendingDraw.WorldMatrices.end(), worldData, worldData + 16);
+                world.Dirty = false;
+                ++m_mergedDrawCount;
+                return;
+            }
+
+            FlushPendingDraw();
+        }
+
+        if (autoSorted)
+        {
+            m_autoSortedDraws.push_back(static_cast<uint64_t>(viewId) << 48 | static_cast<uint64_t>(m_currentProgram->Program.idx) << 32 | sortDepth);
+        }
+
+        if (m_currentBoundIndexBuffer)
+        {
+            m_currentBoundIndexBuffer->SetBgfxIndexBuffer(m_encoder, elementStart, elementCount, m_graphicsImpl.GetFrameIndex());
+        }
+
+        if (submitState != m_lastUniformSubmitState)
+        {
+            m_currentProgram->MarkAllUniformsDirty();
+        }
+
+        SetUniforms(m_encoder, *m_currentProgram, yFlip);
+        m_lastUniformSubmitState = submitState;
+
+        if (autoInstancing)
+        {
+            // Hold the draw back; everything but the state and the submit itself has been set already.
+            m_pendingDraw.Program = m_currentProgram;
+            m_pendingDraw.SubmitState = submitState;
+            m_pendingDraw.BoundVertexArray = m_currentVertexArray;
+            m_pendingDraw.BoundIndexBuffer = m_currentBoundIndexBuffer;
+            m_pendingDraw.ElementStart = elementStart;
+            m_pendingDraw.ElementCount = elementCount;
+
+            const float* worldData = m_currentProgram->GetUniformData(m_currentProgram->Uniforms[m_currentProgram->WorldSlot]);
+            m_pendingDraw.WorldMatrices.assign(worldData, worldData + 16);
+            return;
+        }
+
+        if (instanceBufferData != nullptr)
+        {
+            instanceBufferData->SetAsBgfxInstanceDataBuffer(m_encoder, instanceStart, instanceCount);
+        }
+
+        m_encoder->setState(state);
+        Submit(m_encoder, viewId, m_currentProgram->Program, sortDepth);
+
+#if (ANDROID)
+        if (instanceBufferData != nullptr)
+        {
+            m_encoder->discard(BGFX_DISCARD_INSTANCE_DATA);
+        }
+#endif
+    }
+
+    void NativeEngine::FlushPendingDraw()
+    {
+        if (m_pendingDraw.Program == nullptr)
+        {
+            return;
+        }
+
+        auto& program = *m_pendingDraw.Program;
+        const auto& submitState = m_pendingDraw.SubmitState;
+        const auto instanceCount = static_cast<uint32_t>(m_pendingDraw.WorldMatrices.size() / 16);
+
+        if (instanceCount == 1)
+        {
+            m_encoder->setState(submitState.State);
+            Submit(m_encoder, submitState.ViewId, program.Program, submitState.SortDepth);
+        }
+        else
+        {
+            constexpr uint16_t instanceStride{16 * sizeof(float)};
+
+            uint32_t instancedCount = bgfx::getAvailInstanceDataBuffer(instanceCount, instanceStride);
+            if (instancedCount > 1)
+            {
+                bgfx::InstanceDataBuffer instanceDataBuffer{};
+                bgfx::allocInstanceDataBuffer(&instanceDataBuffer, instancedCount, instanceStride);
+                std::memcpy(instanceDataBuffer.data, m_pendingDraw.WorldMatrices.data(), instancedCount * instanceStride);
+
+                m_encoder->setInstanceDataBuffer(&instanceDataBuffer);
+                m_encoder->setState(submitState.State);
+                Submit(m_encoder, submitState.ViewId, program.InstancedProgram, submitState.SortDepth);
+#if (ANDROID)
+                m_encoder->discard(BGFX_DISCARD_INSTANCE_DATA);
+#endif
+                ++m_instancedSubmitCount;
+            }
+            else
+            {
+                instancedCount = 0;
+            }
+
+            // Instances that did not fit in this frame's instance data are drawn one at a time. The instanced submit
+            // uses a different program and may be sorted after them, so the first of them sets every uniform again.
+            const auto& world = program.Uniforms[program.WorldSlot];
+            program.MarkAllUniformsDirty();
+            if (instanceCount - instancedCount >= MinParallelInstanceCount && (submitState.State & BGFX_STATE_BLEND_MASK) == 0)
+            {
+                SubmitPendingInstancesInParallel(instancedCount, instanceCount);
+            }
+            else
+            {
+                for (uint32_t instance = instancedCount; instance < instanceCount; ++instance)
+                {
+                    SetUniforms(m_encoder, program, submitState.YFlip);
+                    m_encoder->setUniform(world.Handle, m_pendingDraw.WorldMatrices.data() + instance * 16);
+                    m_encoder->setState(submitState.State);
+                    Submit(m_encoder, submitState.ViewId, program.Program, submitState.SortDepth);
                 }
-                else
+            }
+
+            // The world matrix bgfx has last seen is no longer the program's, so the next draw must set everything.
+            m_lastUniformSubmitState = {};
+        }
+
+        m_pendingDraw.Program = nullptr;
+        m_pendingDraw.WorldMatrices.clear();
+    }
+
+    void NativeEngine::SubmitPendingInstancesInParallel(uint32_t firstInstance, uint32_t instanceCount)
+    {
+        const ProgramData& program = *m_pendingDraw.Program;
+        const auto& submitState = m_pendingDraw.SubmitState;
+        const uint32_t frameIndex = m_graphicsImpl.GetFrameIndex();
+
+        // Binding here first makes this frame's copies of transient buffers, so the chunks below only read them.
+        SetPendingDrawBindings(m_encoder, frameIndex);
+
+        // Bindings, uniforms and state are per encoder, so each chunk sets all of them on the encoder it acquires.
+        // The draws are opaque and share a program, state and sort depth, so their order across encoders does not matter.
+        const size_t pooledEncoderCount = bgfx::getCaps()->limits.maxEncoders - 1;
+        const size_t count = instanceCount - firstInstance;
+        const size_t minChunkSize = std::max<size_t>(MinParallelInstanceCount, (count + pooledEncoderCount - 1) / pooledEncoderCount);
+        ParallelFor(count, minChunkSize, 1, [this, &program, &submitState, firstInstance, frameIndex](size_t begin, size_t end) {
+            bgfx::Encoder* encoder = m_graphicsImpl.AcquireEncoder();
+            auto releaseEncoder = gsl::finally([this, encoder] { m_graphicsImpl.ReleaseEncoder(encoder); });
+
+            SetPendingDrawBindings(encoder, frameIndex);
+            for (const auto& value : program.Uniforms)
+            {
+                if (value.ElementLength != 0)
                 {
-                    bgfx::setUniform({it.first}, value.Data.data(), value.ElementLength);
+                    const float* data = (submitState.YFlip && value.YFlip) ? program.GetFlippedUniformData(value) : program.GetUniformData(value);
+                    encoder->setUniform(value.Handle, data, value.ElementLength);
                 }
             }
-            // change culling
-            uint64_t m_engineStateYFlipped = m_engineState;
-            if (m_engineStateYFlipped & ~BGFX_STATE_CULL_MASK)
+
+            const auto& world = program.Uniforms[program.WorldSlot];
+            for (size_t instance = firstInstance + begin; instance < firstInstance + end; ++instance)
             {
-                m_engineStateYFlipped ^= BGFX_STATE_CULL_MASK;
+                encoder->setUniform(world.Handle, m_pendingDraw.WorldMatrices.data() + instance * 16);
+                encoder->setState(submitState.State);
+                Submit(encoder, submitState.ViewId, program.Program, submitState.SortDepth);
             }
-            bgfx::setState(m_engineStateYFlipped | fillModeState);
+        });
+    }
+
+    void NativeEngine::SetPendingDrawBindings(bgfx::Encoder* encoder, uint32_t frameIndex) const
+    {
+        const auto& vertexBuffers = m_pendingDraw.BoundVertexArray->vertexBuffers;
+        for (uint8_t index = 0; index < vertexBuffers.size(); ++index)
+        {
+            const auto& vertexBuffer = vertexBuffers[index];
+            vertexBuffer.data->SetAsBgfxVertexBuffer(encoder, index, vertexBuffer.startVertex, vertexBuffer.byteStride, vertexBuffer.vertexLayoutHandle, frameIndex);
         }
-        else
+
+        if (m_pendingDraw.BoundIndexBuffer)
+        {
+            m_pendingDraw.BoundIndexBuffer->SetBgfxIndexBuffer(encoder, m_pendingDraw.ElementStart, m_pendingDraw.ElementCount, frameIndex);
+        }
+
+        for (const auto& [stage, binding] : m_textureBindings)
+        {
+            if (binding.Texture != bgfx::kInvalidHandle)
+            {
+                encoder->setTexture(stage, bgfx::UniformHandle{binding.Uniform}, bgfx::TextureHandle{binding.Texture}, binding.Flags);
+            }
+        }
+    }
+
+    void NativeEngine::SetProgramUniform(const UniformInfo& info, gsl::span<const float> data, size_t elementLength)
+    {
+        m_currentProgram->SetUniform(info, data, elementLength, [this](uint16_t slot) {
+            FlushBeforeUniformChange(*m_currentProgram, slot);
+        });
+    }
+
+    void NativeEngine::FlushBeforeUniformChange(const ProgramData& program, uint16_t slot)
+    {
+        // Instances of the held back draw that do not fit in the instance data are submitted one at a time with the
+        // program's uniform values, so only its world matrix may change before it is flushed.
+        if (m_pendingDraw.Program == &program && slot != program.WorldSlot)
+        {
+            FlushPendingDraw();
+        }
+    }
+
+    void NativeEngine::SetUniforms(bgfx::Encoder* encoder, ProgramData& program, bool yFlip)
+    {
+        for (auto& value : program.Uniforms)
         {
-            for (const auto& it : m_currentProgram->Uniforms)
+            if (!value.Dirty)
             {
-                const ProgramData::UniformValue& value = it.second;
-                bgfx::setUniform({it.first}, value.Data.data(), value.ElementLength);
+                continue;
             }
-            bgfx::setState(m_engineState | fillModeState);
+
+            const float* data = (yFlip && value.YFlip) ? program.GetFlippedUniformData(value) : program.GetUniformData(value);
+            encoder->setUniform(value.Handle, data, value.ElementLength);
+
+            value.Dirty = false;
+        }
+    }
+
+    void NativeEngine::Submit(bgfx::Encoder* encoder, bgfx::ViewId viewId, bgfx::ProgramHandle program, uint32_t sortDepth)
+    {
+        if (bgfx::isValid(m_conditionQuery))
+        {
+            encoder->setCondition(m_conditionQuery, m_conditionVisible);
         }
 
 #if (ANDROID)
         // TODO : find why we need to discard state on Android
-        bgfx::submit(m_frameBufferManager.GetBound().ViewId, m_currentProgram->Program, 0, false);
+        encoder->submit(viewId, program, m_activeOcclusionQuery, sortDepth, false);
+
+        // Without a state discard the query or condition would carry over to the following draws.
+        if (bgfx::isValid(m_activeOcclusionQuery) || bgfx::isValid(m_conditionQuery))
+        {
+            encoder->discard(BGFX_DISCARD_STATE);
+        }
 #else
-        bgfx::submit(m_frameBufferManager.GetBound().ViewId, m_currentProgram->Program, 0, BGFX_DISCARD_INSTANCE_DATA | BGFX_DISCARD_STATE | BGFX_DISCARD_TRANSFORM);
+        encoder->submit(viewId, program, m_activeOcclusionQuery, sortDepth, BGFX_DISCARD_INSTANCE_DATA | BGFX_DISCARD_STATE | BGFX_DISCARD_TRANSFORM);
 #endif
     }
 
+    Napi::Value NativeEngine::CreateOcclusionQuery(const Napi::CallbackInfo& info)
+    {
+        if ((bgfx::getCaps()->supported & BGFX_CAPS_OCCLUSION_QUERY) == 0)
+        {
+            return info.Env().Null();
+        }
+
+        const bgfx::OcclusionQueryHandle handle = bgfx::createOcclusionQuery();
+        if (!bgfx::isValid(handle))
+        {
+            return info.Env().Null();
+        }
+
+        return Napi::External<OcclusionQueryData>::New(info.Env(), new OcclusionQueryData(handle));
+    }
+
+    void NativeEngine::DeleteOcclusionQuery(const Napi::CallbackInfo& info)
+    {
+        const auto* occlusionQueryData = info[0].As<Napi::External<OcclusionQueryData>>().Data();
+
+        if (m_activeOcclusionQuery.idx == occlusionQueryData->Handle.idx || m_conditionQuery.idx == occlusionQueryData->Handle.idx)
+        {
+            FlushPendingDraw();
+            if (m_activeOcclusionQuery.idx == occlusionQueryData->Handle.idx)
+            {
+                m_activeOcclusionQuery = BGFX_INVALID_HANDLE;
+            }
+            if (m_conditionQuery.idx == occlusionQueryData->Handle.idx)
+            {
+                m_conditionQuery = BGFX_INVALID_HANDLE;
+            }
+        }
+
+        delete occlusionQueryData;
+    }
+
+    void NativeEngine::BeginOcclusionQuery(const Napi::CallbackInfo& info)
+    {
+        const auto* occlusionQueryData = info[0].As<Napi::External<OcclusionQueryData>>().Data();
+
+        FlushPendingDraw();
+        m_activeOcclusionQuery = occlusionQueryData->Handle;
+    }
+
+    void NativeEngine::EndOcclusionQuery(const Napi::CallbackInfo& /*info*/)
+    {
+        FlushPendingDraw();
+        m_activeOcclusionQuery = BGFX_INVALID_HANDLE;
+    }
+
+    Napi::Value NativeEngine::GetOcclusionQueryResult(const Napi::CallbackInfo& info)
+    {
+        const auto* occlusionQueryData = info[0].As<Napi::External<OcclusionQueryData>>().Data();
+
+        // bgfx returns the latest result the GPU has produced, so this never waits. -1 means no result yet.
+        int32_t samples{0};
+        switch (bgfx::getResult(occlusionQueryData->Handle, &samples))
+        {
+            case bgfx::OcclusionQueryResult::Invisible:
+                return Napi::Value::From(info.Env(), 0);
+            case bgfx::OcclusionQueryResult::Visible:
+                // Not every renderer reports a sample count, so a visible result counts at least one sample.
+                return Napi::Value::From(info.Env(), std::max(samples, 1));
+            default:
+                return Napi::Value::From(info.Env(), -1);
+        }
+    }
+
+    void NativeEngine::BeginConditionalRendering(const Napi::CallbackInfo& info)
+    {
+        const auto* occlusionQueryData = info[0].As<Napi::External<OcclusionQueryData>>().Data();
+        const bool visible = info[1].IsUndefined() || info[1].As<Napi::Boolean>().Value();
+
+        FlushPendingDraw();
+        m_conditionQuery = occlusionQueryData->Handle;
+        m_conditionVisible = visible;
+    }
+
+    void NativeEngine::EndConditionalRendering(const Napi::CallbackInfo& /*info*/)
+    {
+        FlushPendingDraw();
+        m_conditionQuery = BGFX_INVALID_HANDLE;
+    }
+
+    void NativeEngine::SetViewSortMode(const Napi::CallbackInfo& info)
+    {
+        FrameBufferData* frameBufferData = info[0].IsNull() || info[0].IsUndefined() ? nullptr : info[0].As<Napi::External<FrameBufferData>>().Data();
+        const auto sortMode = info[1].As<Napi::Number>().Uint32Value();
+        if (sortMode > static_cast<uint32_t>(ViewSortMode::Auto))
+        {
+            throw std::runtime_error{"Unrecognized view sort mode."};
+        }
+
+        FlushPendingDraw();
+        m_frameBufferManager.SetSortMode(frameBufferData, static_cast<ViewSortMode>(sortMode));
+    }
+
+    Napi::Value NativeEngine::GetViewSortStats(const Napi::CallbackInfo& info)
+    {
+        auto stats = Napi::Object::New(info.Env());
+        stats.Set("programChangesSaved", Napi::Value::From(info.Env(), static_cast<double>(m_programChangesSaved)));
+        stats.Set("textureChangesSaved", Napi::Value::From(info.Env(), static_cast<double>(m_textureChangesSaved)));
+        return std::move(stats);
+    }
+
+    Napi::Value NativeEngine::GetResourceStats(const Napi::CallbackInfo& info)
+    {
+        const auto toObject = [env = info.Env()](const Plugins::NativeEngine::ResourceStats::Counter& counter) {
+            auto object = Napi::Object::New(env);
+            object.Set("count", Napi::Value::From(env, static_cast<double>(counter.Count)));
+            object.Set("bytes", Napi::Value::From(env, static_cast<double>(counter.Bytes)));
+            object.Set("peakCount", Napi::Value::From(env, static_cast<double>(counter.PeakCount)));
+            object.Set("peakBytes", Napi::Value::From(env, static_cast<double>(counter.PeakBytes)));
+            return object;
+        };
+
+        const auto resourceStats = Babylon::GetResourceStats();
+        auto stats = Napi::Object::New(info.Env());
+        stats.Set("textures", toObject(resourceStats.Textures));
+        stats.Set("indexBuffers", toObject(resourceStats.IndexBuffers));
+        stats.Set("vertexBuffers", toObject(resourceStats.VertexBuffers));
+        stats.Set("instanceBuffers", toObject(resourceStats.InstanceBuffers));
+        stats.Set("storageBuffers", toObject(resourceStats.StorageBuffers));
+        stats.Set("frameBuffers", toObject(resourceStats.FrameBuffers));
+        stats.Set("programs", toObject(resourceStats.Programs));
+        return std::move(stats);
+    }
+
+    Napi::Value NativeEngine::GetFrameStats(const Napi::CallbackInfo& info)
+    {
+        const auto env = info.Env();
+        const Graphics::FrameStats frameStats = m_graphicsImpl.GetFrameStats();
+
+        auto views = Napi::Array::New(env, frameStats.Views.size());
+        for (uint32_t index = 0; index < frameStats.Views.size(); ++index)
+        {
+            const auto& view = frameStats.Views[index];
+            auto viewStats = Napi::Object::New(env);
+            viewStats.Set("name", Napi::String::New(env, view.Name));
+            viewStats.Set("id", Napi::Value::From(env, view.Id));
+            viewStats.Set("cpuTimeMs", Napi::Value::From(env, view.CpuTimeMs));
+            viewStats.Set("gpuTimeMs", Napi::Value::From(env, view.GpuTimeMs));
+            views.Set(index, viewStats);
+        }
+
+        auto stats = Napi::Object::New(env);
+        stats.Set("drawCount", Napi::Value::From(env, frameStats.DrawCount));
+        stats.Set("computeCount", Napi::Value::From(env, frameStats.ComputeCount));
+        stats.Set("blitCount", Napi::Value::From(env, frameStats.BlitCount));
+        stats.Set("cpuFrameTimeMs", Napi::Value::From(env, frameStats.CpuFrameTimeMs));
+        stats.Set("cpuSubmitTimeMs", Napi::Value::From(env, frameStats.CpuSubmitTimeMs));
+        stats.Set("gpuFrameTimeMs", Napi::Value::From(env, frameStats.GpuFrameTimeMs));
+        stats.Set("waitRenderTimeMs", Napi::Value::From(env, frameStats.WaitRenderTimeMs));
+        stats.Set("waitSubmitTimeMs", Napi::Value::From(env, frameStats.WaitSubmitTimeMs));
+        stats.Set("transientVertexBytesUsed", Napi::Value::From(env, frameStats.TransientVertexBytesUsed));
+        stats.Set("transientIndexBytesUsed", Napi::Value::From(env, frameStats.TransientIndexBytesUsed));
+        stats.Set("textureMemoryUsed", Napi::Value::From(env, static_cast<double>(frameStats.TextureMemoryUsed)));
+        stats.Set("renderTargetMemoryUsed", Napi::Value::From(env, static_cast<double>(frameStats.RenderTargetMemoryUsed)));
+        stats.Set("viewOverflowCount", Napi::Value::From(env, m_frameBufferManager.GetViewOverflowCount()));
+        stats.Set("views", views);
+        return std::move(stats);
+    }
+
+    void NativeEngine::SetViewProfilingEnabled(const Napi::CallbackInfo& info)
+    {
+        m_graphicsImpl.SetViewProfilingEnabled(info[0].ToBoolean().Value());
+    }
+
+    void NativeEngine::SetFrameBufferName(const Napi::CallbackInfo& info)
+    {
+        FrameBufferData* frameBufferData = info[0].IsNull() || info[0].IsUndefined() ? nullptr : info[0].As<Napi::External<FrameBufferData>>().Data();
+        m_frameBufferManager.SetName(frameBufferData, info[1].As<Napi::String>().Utf8Value());
+    }
+
+    void NativeEngine::CountAutoSortSavings()
+    {
+        constexpr uint64_t viewMask{0xffffull << 48};
+        constexpr uint64_t programMask{viewMask | 0xffffull << 32};
+        constexpr uint64_t textureMask{~0ull};
+
+        // Submission order within each view, then the order bgfx will draw them in.
+        std::stable_sort(m_autoSortedDraws.begin(), m_autoSortedDraws.end(), [](uint64_t a, uint64_t b) {
+            return (a & viewMask) < (b & viewMask);
+        });
+        const uint32_t submittedProgramChanges = CountChanges(m_autoSortedDraws, programMask);
+        const uint32_t submittedTextureChanges = CountChanges(m_autoSortedDraws, textureMask);
+
+        std::stable_sort(m_autoSortedDraws.begin(), m_autoSortedDraws.end());
+        m_programChangesSaved += submittedProgramChanges - CountChanges(m_autoSortedDraws, programMask);
+        m_textureChangesSaved += submittedTextureChanges - CountChanges(m_autoSortedDraws, textureMask);
+
+        m_autoSortedDraws.clear();
+    }
+
+    void NativeEngine::CullBoundingBoxes(const Napi::CallbackInfo& info)
+    {
+        const auto boxes = info[0].As<Napi::Float32Array>();
+        const auto count = info[1].As<Napi::Number>().Uint32Value();
+        const auto planes = info[2].As<Napi::Float32Array>();
+        auto visibility = info[3].As<Napi::Uint32Array>();
+
+        FrustumCulling::CullBoxes(
+            gsl::make_span(boxes.Data(), boxes.ElementLength()),
+            count,
+            gsl::make_span(planes.Data(), planes.ElementLength()),
+            gsl::make_span(visibility.Data(), visibility.ElementLength()));
+    }
+
+    void NativeEngine::CullBoundingSpheres(const Napi::CallbackInfo& info)
+    {
+        const auto spheres = info[0].As<Napi::Float32Array>();
+        const auto count = info[1].As<Napi::Number>().Uint32Value();
+        const auto planes = info[2].As<Napi::Float32Array>();
+        auto visibility = info[3].As<Napi::Uint32Array>();
+
+        FrustumCulling::CullSpheres(
+            gsl::make_span(spheres.Data(), spheres.ElementLength()),
+            count,
+            gsl::make_span(planes.Data(), planes.ElementLength()),
+            gsl::make_span(visibility.Data(), visibility.ElementLength()));
+    }
+
+    Napi::Value NativeEngine::GetInstancingStats(const Napi::CallbackInfo& info)
+    {
+        auto stats = Napi::Object::New(info.Env());
+        stats.Set("mergedDrawCount", Napi::Value::From(info.Env(), m_mergedDrawCount));
+        stats.Set("instancedSubmitCount", Napi::Value::From(info.Env(), m_instancedSubmitCount));
+        return std::move(stats);
+    }
+
     void NativeEngine::Draw(const Napi::CallbackInfo& info)
     {
-        bgfx::discard(BGFX_DISCARD_INDEX_BUFFER);
+        const auto fillMode = info[0].As<Napi::Number>().Int32Value();
+        const auto elementStart = info[1].As<Napi::Number>().Uint32Value();
+        const auto elementCount = info[2].As<Napi::Number>().Uint32Value();
+
+        Draw(fillMode, elementStart, elementCount);
+    }
+
+    void NativeEngine::Draw(int32_t fillMode, uint32_t elementStart, uint32_t elementCount)
+    {
+        FlushPendingDraw();
+        m_encoder->discard(BGFX_DISCARD_INDEX_BUFFER);
         m_currentBoundIndexBuffer = nullptr;
-        DrawIndexed(info);
+        DrawIndexed(fillMode, elementStart, elementCount);
     }
 
     void NativeEngine::Clear(const Napi::CallbackInfo& info)
     {
+        FlushPendingDraw();
         m_frameBufferManager.GetBound().ViewClearState.UpdateFlags(info);
     }
 
     void NativeEngine::ClearColor(const Napi::CallbackInfo& info)
     {
+        FlushPendingDraw();
         m_frameBufferManager.GetBound().ViewClearState.UpdateColor(info);
     }
 
     void NativeEngine::ClearStencil(const Napi::CallbackInfo& info)
     {
+        FlushPendingDraw();
         m_frameBufferManager.GetBound().ViewClearState.UpdateStencil(info);
     }
 
     void NativeEngine::ClearDepth(const Napi::CallbackInfo& info)
     {
+        FlushPendingDraw();
         m_frameBufferManager.GetBound().ViewClearState.UpdateDepth(info);
     }
 
@@ -1459,18 +3067,295 @@ namespace Babylon
         const auto width = info[2].As<Napi::Number>().FloatValue();
         const auto height = info[3].As<Napi::Number>().FloatValue();
 
+        SetViewPort(x, y, width, height);
+    }
+
+    void NativeEngine::SetViewPort(float x, float y, float width, float height)
+    {
+        FlushPendingDraw();
+
         const auto backbufferWidth = bgfx::getStats()->width;
         const auto backbufferHeight = bgfx::getStats()->height;
         const float yOrigin = bgfx::getCaps()->originBottomLeft ? y : (1.f - y - height);
 
-        m_frameBufferManager.GetBound().UseViewId(m_frameBufferManager.GetNewViewId());
-        const bgfx::ViewId viewId = m_frameBufferManager.GetBound().ViewId;
-        bgfx::setViewFrameBuffer(viewId, m_frameBufferManager.GetBound().FrameBuffer);
-        bgfx::setViewRect(viewId,
+        const FrameBufferManager::ViewRect rect{
             static_cast<uint16_t>(x * backbufferWidth),
             static_cast<uint16_t>(yOrigin * backbufferHeight),
             static_cast<uint16_t>(width * backbufferWidth),
-            static_cast<uint16_t>(height * backbufferHeight));
+            static_cast<uint16_t>(height * backbufferHeight)};
+
+        FrameBufferData& frameBuffer = m_frameBufferManager.GetBound();
+        frameBuffer.UseViewId(m_frameBufferManager.AcquireViewId(frameBuffer, rect));
+        const bgfx::ViewId viewId = frameBuffer.ViewId;
+        bgfx::setViewFrameBuffer(viewId, frameBuffer.FrameBuffer);
+        bgfx::setViewRect(viewId, rect.X, rect.Y, rect.Width, rect.Height);
+    }
+
+    void NativeEngine::SubmitCommands(const Napi::CallbackInfo& info)
+    {
+        // The command buffer, then the vertex arrays, programs, uniforms, textures and frame buffers its commands
+        // refer to, each of which may be left out when no command uses it.
+        const auto commands = info[0].As<Napi::Uint8Array>();
+        const auto getObjects = [&info](size_t index) {
+            return info[index].IsUndefined() ? Napi::Array::New(info.Env()) : info[index].As<Napi::Array>();
+        };
+
+        CommandStream stream{commands.Data(), commands.ByteLength(), {getObjects(1), getObjects(2), getObjects(3), getObjects(4), getObjects(5)}};
+        while (!stream.AtEnd())
+        {
+            switch (stream.ReadCommand())
+            {
+                case Command::BindVertexArray:
+                {
+                    BindVertexArray(*stream.ReadObject<VertexArray>());
+                    break;
+                }
+                case Command::SetProgram:
+                {
+                    SetProgram(stream.ReadObject<ProgramData>());
+                    break;
+                }
+                case Command::SetState:
+                {
+                    const auto culling = stream.ReadBool();
+                    const auto zOffset = stream.ReadFloat();
+                    const auto reverseSide = stream.ReadBool();
+                    SetState(culling, zOffset, reverseSide);
+                    break;
+                }
+                case Command::SetDepthTest:
+                {
+                    SetDepthTest(stream.ReadUint32());
+                    break;
+                }
+                case Command::SetDepthWrite:
+                {
+                    SetDepthWrite(stream.ReadBool());
+                    break;
+                }
+                case Command::SetColorWrite:
+                {
+                    SetColorWrite(stream.ReadBool());
+                    break;
+                }
+                case Command::SetBlendMode:
+                {
+                    static_assert(BGFX_STATE_BLEND_MASK <= std::numeric_limits<uint32_t>::max());
+                    SetBlendMode(stream.ReadUint32());
+                    break;
+                }
+                case Command::SetMatrix:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetMatrixN<4>(uniformInfo, stream.ReadArray<float>());
+                    break;
+                }
+                case Command::SetMatrix3x3:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetMatrixN<3>(uniformInfo, stream.ReadArray<float>());
+                    break;
+                }
+                case Command::SetMatrix2x2:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetMatrixN<2>(uniformInfo, stream.ReadArray<float>());
+                    break;
+                }
+                case Command::SetMatrices:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetMatrices(uniformInfo, stream.ReadArray<float>());
+                    break;
+                }
+                case Command::SetInt:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetInt(uniformInfo, stream.ReadInt32());
+                    break;
+                }
+                case Command::SetIntArray:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetTypeArrayN<1>(uniformInfo, stream.ReadArray<int32_t>());
+                    break;
+                }
+                case Command::SetIntArray2:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetTypeArrayN<2>(uniformInfo, stream.ReadArray<int32_t>());
+                    break;
+                }
+                case Command::SetIntArray3:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetTypeArrayN<3>(uniformInfo, stream.ReadArray<int32_t>());
+                    break;
+                }
+                case Command::SetIntArray4:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetTypeArrayN<4>(uniformInfo, stream.ReadArray<int32_t>());
+                    break;
+                }
+                case Command::SetFloatArray:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetTypeArrayN<1>(uniformInfo, stream.ReadArray<float>());
+                    break;
+                }
+                case Command::SetFloatArray2:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetTypeArrayN<2>(uniformInfo, stream.ReadArray<float>());
+                    break;
+                }
+                case Command::SetFloatArray3:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetTypeArrayN<3>(uniformInfo, stream.ReadArray<float>());
+                    break;
+                }
+                case Command::SetFloatArray4:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetTypeArrayN<4>(uniformInfo, stream.ReadArray<float>());
+                    break;
+                }
+                case Command::SetFloat:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    const float values[] = {stream.ReadFloat(), 0.f, 0.f, 0.f};
+                    SetFloatN<1>(uniformInfo, values);
+                    break;
+                }
+                case Command::SetFloat2:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    const auto x = stream.ReadFloat();
+                    const auto y = stream.ReadFloat();
+                    const float values[] = {x, y, 0.f, 0.f};
+                    SetFloatN<2>(uniformInfo, values);
+                    break;
+                }
+                case Command::SetFloat3:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    const auto x = stream.ReadFloat();
+                    const auto y = stream.ReadFloat();
+                    const auto z = stream.ReadFloat();
+                    const float values[] = {x, y, z, 0.f};
+                    SetFloatN<3>(uniformInfo, values);
+                    break;
+                }
+                case Command::SetFloat4:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    const auto x = stream.ReadFloat();
+                    const auto y = stream.ReadFloat();
+                    const auto z = stream.ReadFloat();
+                    const auto w = stream.ReadFloat();
+                    const float values[] = {x, y, z, w};
+                    SetFloatN<4>(uniformInfo, values);
+                    break;
+                }
+                case Command::SetTexture:
+                {
+                    const auto uniformInfo = stream.ReadObject<UniformInfo>();
+                    SetTexture(uniformInfo, stream.ReadObject<TextureData>());
+                    break;
+                }
+                case Command::SetTextureSampling:
+                {
+                    const auto texture = stream.ReadObject<TextureData>();
+                    SetTextureSampling(texture, stream.ReadUint32());
+                    break;
+                }
+                case Command::SetTextureWrapMode:
+                {
+                    const auto texture = stream.ReadObject<TextureData>();
+                    const auto addressModeU = stream.ReadUint32();
+                    const auto addressModeV = stream.ReadUint32();
+                    const auto addressModeW = stream.ReadUint32();
+                    SetTextureWrapMode(texture, addressModeU, addressModeV, addressModeW);
+                    break;
+                }
+                case Command::SetTextureAnisotropicLevel:
+                {
+                    const auto texture = stream.ReadObject<TextureData>();
+                    SetTextureAnisotropicLevel(texture, stream.ReadUint32());
+                    break;
+                }
+                case Command::BindFrameBuffer:
+                {
+                    BindFrameBuffer(stream.ReadObject<FrameBufferData>());
+                    break;
+                }
+                case Command::UnbindFrameBuffer:
+                {
+                    UnbindFrameBuffer(stream.ReadObject<FrameBufferData>());
+                    break;
+                }
+                case Command::DrawIndexed:
+                {
+                    const auto fillMode = stream.ReadInt32();
+                    const auto elementStart = stream.ReadUint32();
+                    const auto elementCount = stream.ReadUint32();
+                    DrawIndexed(fillMode, elementStart, elementCount);
+                    break;
+                }
+                case Command::Draw:
+                {
+                    const auto fillMode = stream.ReadInt32();
+                    const auto elementStart = stream.ReadUint32();
+                    const auto elementCount = stream.ReadUint32();
+                    Draw(fillMode, elementStart, elementCount);
+                    break;
+                }
+                case Command::Clear:
+                {
+                    FlushPendingDraw();
+                    m_frameBufferManager.GetBound().ViewClearState.UpdateFlags(static_cast<uint16_t>(stream.ReadUint32()));
+                    break;
+                }
+                case Command::ClearColor:
+                {
+                    FlushPendingDraw();
+                    const auto r = stream.ReadFloat();
+                    const auto g = stream.ReadFloat();
+                    const auto b = stream.ReadFloat();
+                    const auto a = stream.ReadFloat();
+                    m_frameBufferManager.GetBound().ViewClearState.UpdateColor(r, g, b, a);
+                    break;
+                }
+                case Command::ClearDepth:
+                {
+                    FlushPendingDraw();
+                    m_frameBufferManager.GetBound().ViewClearState.UpdateDepth(stream.ReadFloat());
+                    break;
+                }
+                case Command::ClearStencil:
+                {
+                    FlushPendingDraw();
+                    m_frameBufferManager.GetBound().ViewClearState.UpdateStencil(static_cast<uint8_t>(stream.ReadUint32()));
+                    break;
+                }
+                case Command::SetViewPort:
+                {
+                    const auto x = stream.ReadFloat();
+                    const auto y = stream.ReadFloat();
+                    const auto width = stream.ReadFloat();
+                    const auto height = stream.ReadFloat();
+                    SetViewPort(x, y, width, height);
+                    break;
+                }
+                case Command::Reserved:
+                case Command::Count:
+                {
+                    throw std::runtime_error{"Unrecognized command in command buffer."};
+                }
+            }
+        }
     }
 
     void NativeEngine::GetFramebufferData(const Napi::CallbackInfo& info)
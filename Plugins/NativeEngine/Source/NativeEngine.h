@@ -2,6 +2,9 @@
 
 #include "ShaderCompiler.h"
 #include "BgfxCallback.h"
+#include "GeometryHeap.h"
+#include "ResourceStats.h"
+#include "TextureStreamer.h"
 
 #include <Babylon/JsRuntime.h>
 #include <Babylon/JsRuntimeScheduler.h>
@@ -16,6 +19,7 @@
 #include <bgfx/platform.h>
 #include <bimg/bimg.h>
 #include <bx/allocator.h>
+#include <bx/simd_t.h>
 
 #include <gsl/gsl>
 
@@ -23,6 +27,13 @@
 
 #include <arcana/containers/weak_table.h>
 #include <arcana/threading/cancellation.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace Babylon
@@ -45,14 +56,22 @@ namespace Babylon
 
         void UpdateFlags(const Napi::CallbackInfo& info)
         {
-            const auto flags = static_cast<uint16_t>(info[0].As<Napi::Number>().Uint32Value());
+            UpdateFlags(static_cast<uint16_t>(info[0].As<Napi::Number>().Uint32Value()));
+        }
+
+        void UpdateFlags(uint16_t flags)
+        {
             Flags = flags;
             Update();
         }
 
         void UpdateDepth(const Napi::CallbackInfo& info)
         {
-            const auto depth = info[0].As<Napi::Number>().FloatValue();
+            UpdateDepth(info[0].As<Napi::Number>().FloatValue());
+        }
+
+        void UpdateDepth(float depth)
+        {
             const bool needToUpdate = Depth != depth;
             if (needToUpdate)
             {
@@ -63,7 +82,11 @@ namespace Babylon
 
         void UpdateStencil(const Napi::CallbackInfo& info)
         {
-            const auto stencil = static_cast<uint8_t>(info[0].As<Napi::Number>().Int32Value());
+            UpdateStencil(static_cast<uint8_t>(info[0].As<Napi::Number>().Int32Value()));
+        }
+
+        void UpdateStencil(uint8_t stencil)
+        {
             const bool needToUpdate = Stencil != stencil;
             if (needToUpdate)
             {
@@ -138,22 +161,42 @@ namespace Babylon
             m_clearState.UpdateFlags(info);
         }
 
+        void UpdateFlags(uint16_t flags)
+        {
+            m_clearState.UpdateFlags(flags);
+        }
+
         void UpdateDepth(const Napi::CallbackInfo& info)
         {
             m_clearState.UpdateDepth(info);
         }
 
+        void UpdateDepth(float depth)
+        {
+            m_clearState.UpdateDepth(depth);
+        }
+
         void UpdateStencil(const Napi::CallbackInfo& info)
         {
             m_clearState.UpdateStencil(info);
         }
 
+        void UpdateStencil(uint8_t stencil)
+        {
+            m_clearState.UpdateStencil(stencil);
+        }
+
         void UpdateViewId(uint16_t viewId)
         {
             m_viewId = viewId;
             Update();
         }
 
+        uint16_t Flags() const
+        {
+            return m_clearState.Flags;
+        }
+
     private:
 
         void Update() const
@@ -168,6 +211,18 @@ namespace Babylon
         arcana::weak_table<std::function<void()>>::ticket m_callbackTicket;
     };
 
+    /// How the draws submitted to a frame buffer's view are ordered by bgfx. The values are exposed to
+    /// JavaScript as VIEW_SORT_MODE_* constants on the engine.
+    enum class ViewSortMode : uint32_t
+    {
+        /// bgfx's default order: by blend state and then by program, keeping submission order otherwise.
+        Default = 0,
+        /// Submission order.
+        Sequential,
+        /// Like Default, but opaque draws using the same program are also grouped by their bound textures.
+        Auto,
+    };
+
     struct FrameBufferData final
     {
     private:
@@ -209,6 +264,16 @@ namespace Babylon
         {
             ViewId = viewId;
             ViewClearState.UpdateViewId(ViewId);
+            UpdateViewMode();
+
+            // Views are shared between frame buffers from frame to frame, so the name goes with each view taken.
+            bgfx::setViewName(ViewId, Name.c_str());
+        }
+
+        void UpdateViewMode() const
+        {
+            // View ids are handed out again every frame, so the mode is set whenever one is taken.
+            bgfx::setViewMode(ViewId, SortMode == ViewSortMode::Sequential ? bgfx::ViewMode::Sequential : bgfx::ViewMode::Default);
         }
 
         void SetUpView(uint16_t viewId)
@@ -228,23 +293,60 @@ namespace Babylon
         // When this flag is true, projection matrix will not be flipped for API that would normaly need it.
         // Namely Direct3D and Metal.
         bool ActAsBackBuffer{false};
+        ViewSortMode SortMode{ViewSortMode::Default};
+        TrackedResource Tracked{};
+
+        /// Name of the views rendering to this frame buffer, as bgfx reports them in its stats and to tools.
+        std::string Name{};
     };
 
     struct FrameBufferManager final
     {
+        /// Area of a frame buffer a view renders to, in pixels.
+        struct ViewRect
+        {
+            uint16_t X{};
+            uint16_t Y{};
+            uint16_t Width{};
+            uint16_t Height{};
+
+            bool operator==(const ViewRect& other) const
+            {
+                return X == other.X && Y == other.Y && Width == other.Width && Height == other.Height;
+            }
+        };
+
         FrameBufferManager()
         {
-            m_boundFrameBuffer = m_backBuffer = new FrameBufferData(BGFX_INVALID_HANDLE, GetNewViewId(), bgfx::getStats()->width, bgfx::getStats()->height);
+            m_nextId = 1;
+            m_boundFrameBuffer = m_backBuffer = new FrameBufferData(BGFX_INVALID_HANDLE, m_nextId, bgfx::getStats()->width, bgfx::getStats()->height);
+            m_backBuffer->Name = "Back buffer";
+            m_viewOwner = m_backBuffer;
+            m_viewRect = {0, 0, m_backBuffer->Width, m_backBuffer->Height};
+            m_viewUsed = false;
         }
 
+        // Frame buffers only get a view of their own when they are bound.
         FrameBufferData* CreateNew(bgfx::FrameBufferHandle frameBufferHandle, uint16_t width, uint16_t height)
         {
-            return new FrameBufferData(frameBufferHandle, GetNewViewId(), width, height);
+            return Named(new FrameBufferData(frameBufferHandle, m_nextId, width, height));
         }
 
         FrameBufferData* CreateNew(bgfx::FrameBufferHandle frameBufferHandle, ClearState& clearState, uint16_t width, uint16_t height, bool actAsBackBuffer)
         {
-            return new FrameBufferData(frameBufferHandle, GetNewViewId(), clearState, width, height, actAsBackBuffer);
+            return Named(new FrameBufferData(frameBufferHandle, m_nextId, clearState, width, height, actAsBackBuffer));
+        }
+
+        /// Sets the name of a frame buffer, or of the back buffer when data is null.
+        void SetName(FrameBufferData* data, std::string name)
+        {
+            FrameBufferData* frameBuffer = data != nullptr ? data : m_backBuffer;
+            frameBuffer->Name = std::move(name);
+
+            if (frameBuffer == m_boundFrameBuffer)
+            {
+                bgfx::setViewName(frameBuffer->ViewId, frameBuffer->Name.c_str());
+            }
         }
 
         void Bind(FrameBufferData* data)
@@ -253,7 +355,7 @@ namespace Babylon
 
             // TODO: Consider doing this only on bgfx::reset(); the effects of this call don't survive reset, but as
             // long as there's no reset this doesn't technically need to be called every time the frame buffer is bound.
-            m_boundFrameBuffer->SetUpView(GetNewViewId());
+            m_boundFrameBuffer->SetUpView(AcquireViewId(*m_boundFrameBuffer, {0, 0, m_boundFrameBuffer->Width, m_boundFrameBuffer->Height}));
 
             // bgfx::setTexture()? Why?
             // TODO: View order?
@@ -265,6 +367,20 @@ namespace Babylon
             return *m_boundFrameBuffer;
         }
 
+        /// Sets the sort mode of a frame buffer, or of the back buffer when data is null.
+        void SetSortMode(FrameBufferData* data, ViewSortMode sortMode)
+        {
+            FrameBufferData* frameBuffer = data != nullptr ? data : m_backBuffer;
+            frameBuffer->SortMode = sortMode;
+
+            // The view id of a frame buffer that is not bound may belong to another one by now; it picks
+            // the mode up when it is next given a view id.
+            if (frameBuffer == m_boundFrameBuffer)
+            {
+                frameBuffer->UpdateViewMode();
+            }
+        }
+
         void Unbind(FrameBufferData* data)
         {
             // this assert is commented because of an issue with XR described here : https://github.com/BabylonJS/BabylonNative/issues/344
@@ -274,16 +390,76 @@ namespace Babylon
             m_renderingToTarget = false;
         }
 
-        uint16_t GetNewViewId()
+        /// Returns the view id to render the given frame buffer and rect with. The latest view is reused when
+        /// nothing has been drawn to it yet, or when it already renders the same frame buffer and rect and reusing
+        /// it does not skip a clear; otherwise the next view id is taken.
+        uint16_t AcquireViewId(const FrameBufferData& frameBuffer, const ViewRect& rect)
         {
-            m_nextId++;
-            assert(m_nextId < bgfx::getCaps()->limits.maxViews);
+            const bool sameTarget = &frameBuffer == m_viewOwner && frameBuffer.FrameBuffer.idx == m_viewOwnerHandle && rect == m_viewRect;
+
+            // The back buffer keeps drawing to its view after a frame buffer is unbound, so its view is not given away.
+            const bool reusable = m_viewUsed
+                ? sameTarget && frameBuffer.ViewClearState.Flags() == BGFX_CLEAR_NONE
+                : (m_viewOwner != m_backBuffer || &frameBuffer == m_backBuffer);
+
+            if (!reusable)
+            {
+                if (m_nextId + 1 < bgfx::getCaps()->limits.maxViews)
+                {
+                    ++m_nextId;
+                    m_viewUsed = false;
+                }
+                else
+                {
+                    // Out of views: keep rendering to the last one rather than failing, and count it.
+                    ++m_viewOverflowCount;
+                }
+            }
+
+            m_viewOwner = &frameBuffer;
+            m_viewOwnerHandle = frameBuffer.FrameBuffer.idx;
+            m_viewRect = rect;
+            return m_nextId;
+        }
+
+        /// Takes the next view id for work that renders to no frame buffer data of its own, or returns nothing when
+        /// every view id of the frame is taken.
+        std::optional<uint16_t> AcquireSpareViewId()
+        {
+            if (m_nextId + 1 >= bgfx::getCaps()->limits.maxViews)
+            {
+                ++m_viewOverflowCount;
+                return {};
+            }
+
+            ++m_nextId;
+            m_viewOwner = nullptr;
+            m_viewOwnerHandle = bgfx::kInvalidHandle;
+            m_viewUsed = true;
             return m_nextId;
         }
 
+        /// Records that a draw was submitted to the given view.
+        void MarkViewUsed(bgfx::ViewId viewId)
+        {
+            if (viewId == m_nextId)
+            {
+                m_viewUsed = true;
+            }
+        }
+
+        /// Number of times a view was needed once every view id of the frame was taken.
+        uint32_t GetViewOverflowCount() const
+        {
+            return m_viewOverflowCount;
+        }
+
         void Reset()
         {
+            // View 0 belongs to the application, so it is never reused for a frame buffer.
             m_nextId = 0;
+            m_viewOwner = nullptr;
+            m_viewUsed = true;
         }
 
         bool IsRenderingToTarget() const
@@ -292,10 +468,23 @@ namespace Babylon
         }
 
     private:
+        static FrameBufferData* Named(FrameBufferData* frameBuffer)
+        {
+            frameBuffer->Name = "Frame buffer " + std::to_string(frameBuffer->FrameBuffer.idx);
+            return frameBuffer;
+        }
+
         FrameBufferData* m_boundFrameBuffer{nullptr};
         FrameBufferData* m_backBuffer{nullptr};
         uint16_t m_nextId{0};
         bool m_renderingToTarget{false};
+
+        // Target of the latest view, m_nextId, and whether anything has been drawn to it.
+        const FrameBufferData* m_viewOwner{nullptr};
+        uint16_t m_viewOwnerHandle{bgfx::kInvalidHandle};
+        ViewRect m_viewRect{};
+        bool m_viewUsed{true};
+        uint32_t m_viewOverflowCount{};
     };
 
     struct TextureData final
@@ -313,6 +502,9 @@ namespace Babylon
         uint32_t Height{0};
         uint32_t Flags{0};
         uint8_t AnisotropicLevel{0};
+
+        /// Textures owned by a frame buffer are counted with the frame buffer rather than here.
+        TrackedResource Tracked{};
     };
 
     struct ImageData final
@@ -329,9 +521,14 @@ namespace Babylon
 
     struct UniformInfo final
     {
+        static constexpr uint16_t kInvalidSlot{std::numeric_limits<uint16_t>::max()};
+
         uint8_t Stage{};
         bgfx::UniformHandle Handle{bgfx::kInvalidHandle};
         bool YFlip{false};
+
+        /// Index of this uniform's value in ProgramData::Uniforms, or kInvalidSlot for samplers.
+        uint16_t Slot{kInvalidSlot};
     };
 
     struct ProgramData final
@@ -343,42 +540,410 @@ namespace Babylon
         ~ProgramData()
         {
             bgfx::destroy(Program);
+
+            if (bgfx::isValid(InstancedProgram))
+            {
+                bgfx::destroy(InstancedProgram);
+            }
         }
 
         std::unordered_map<std::string, uint32_t> VertexAttributeLocations{};
         std::unordered_map<std::string, UniformInfo> VertexUniformInfos{};
         std::unordered_map<std::string, UniformInfo> FragmentUniformInfos{};
 
+        /// Uniforms of a compute program, which has no vertex or fragment uniforms.
+        std::unordered_map<std::string, UniformInfo> ComputeUniformInfos{};
+
+        /// Stages of the storage buffers and images of a compute program, by name.
+        std::unordered_map<std::string, uint8_t> ComputeStorageStages{};
+
+        bool IsCompute{false};
+
         bgfx::ProgramHandle Program{};
 
+        /// Variant of Program that reads the world matrix from instance data rather than from the
+        /// world uniform. Only valid for programs created with automatic instancing enabled.
+        bgfx::ProgramHandle InstancedProgram{bgfx::kInvalidHandle};
+
+        /// Slot of the world matrix uniform replaced in InstancedProgram.
+        uint16_t WorldSlot{UniformInfo::kInvalidSlot};
+
+        /// Counts the program, by the size of its shader binaries.
+        TrackedResource Tracked{};
+
+        /// Results of the hashed reflection lookups for names the program does not have, and for hashes
+        /// shared by several of its names, which have to be looked up by name instead.
+        static constexpr int32_t kReflectionNotFound{-1};
+        static constexpr int32_t kReflectionAmbiguous{-2};
+
+        /// 32-bit FNV-1a hash of a name's UTF-8 bytes, the hash JavaScript passes to the hashed lookups.
+        static uint32_t HashName(std::string_view name)
+        {
+            uint32_t hash{2166136261u};
+            for (const char character : name)
+            {
+                hash = (hash ^ static_cast<uint8_t>(character)) * 16777619u;
+            }
+            return hash;
+        }
+
+        /// Every uniform of the program, including samplers, indexed by reflection slot. Uniforms used by
+        /// both shaders appear once, as the vertex shader's.
+        std::vector<const UniformInfo*> ReflectedUniforms{};
+
+        /// Builds the hashed reflection tables, once the uniform infos and attribute locations are final.
+        void BuildReflection()
+        {
+            for (const auto& [name, uniformInfo] : VertexUniformInfos)
+            {
+                AddReflectionEntry(m_uniformHashes, HashName(name), gsl::narrow_cast<int32_t>(ReflectedUniforms.size()));
+                ReflectedUniforms.push_back(&uniformInfo);
+            }
+
+            for (const auto& [name, uniformInfo] : FragmentUniformInfos)
+            {
+                if (VertexUniformInfos.find(name) == VertexUniformInfos.end())
+                {
+                    AddReflectionEntry(m_uniformHashes, HashName(name), gsl::narrow_cast<int32_t>(ReflectedUniforms.size()));
+                    ReflectedUniforms.push_back(&uniformInfo);
+                }
+            }
+
+            for (const auto& [name, uniformInfo] : ComputeUniformInfos)
+            {
+                AddReflectionEntry(m_uniformHashes, HashName(name), gsl::narrow_cast<int32_t>(ReflectedUniforms.size()));
+                ReflectedUniforms.push_back(&uniformInfo);
+            }
+
+            for (const auto& [name, location] : VertexAttributeLocations)
+            {
+                AddReflectionEntry(m_attributeHashes, HashName(name), gsl::narrow_cast<int32_t>(location));
+            }
+
+            SortReflectionEntries(m_uniformHashes);
+            SortReflectionEntries(m_attributeHashes);
+        }
+
+        /// Reflection slot of the uniform whose name has the given hash.
+        int32_t FindReflectedUniform(uint32_t nameHash) const
+        {
+            return FindReflectionEntry(m_uniformHashes, nameHash);
+        }
+
+        /// Location of the vertex attribute whose name has the given hash.
+        int32_t FindReflectedAttribute(uint32_t nameHash) const
+        {
+            return FindReflectionEntry(m_attributeHashes, nameHash);
+        }
+
+        /// A uniform's region of UniformData. Offset and Capacity are in floats; ElementLength is
+        /// the number of vec4/mat4 elements last written, which is what gets passed to bgfx.
+        /// Y-flipped uniforms also have a region of the same size in FlippedUniformData.
         struct UniformValue
         {
-            std::vector<float> Data{};
+            bgfx::UniformHandle Handle{bgfx::kInvalidHandle};
+            uint32_t Offset{};
+            uint32_t FlippedOffset{};
+            uint32_t Capacity{};
+            uint16_t ElementSize{};
             uint16_t ElementLength{};
             bool YFlip{false};
+            bool Dirty{false};
         };
 
-        std::unordered_map<uint16_t, UniformValue> Uniforms{};
+        std::vector<UniformValue> Uniforms{};
+
+        /// Values of every non-sampler uniform of the program, laid out back to back. Stored as
+        /// SIMD vectors so every uniform starts on a 16-byte boundary.
+        std::vector<bx::simd128_t> UniformData{};
+
+        /// Copies of the Y-flipped uniforms with the clip-space Y axis negated, kept up to date as
+        /// the uniforms are set so that rendering to a target does not have to flip them per draw.
+        std::vector<bx::simd128_t> FlippedUniformData{};
+
+        size_t UniformDataSize() const
+        {
+            return UniformData.size() * 4;
+        }
+
+        float* GetUniformData(const UniformValue& value)
+        {
+            return reinterpret_cast<float*>(UniformData.data()) + value.Offset;
+        }
+
+        const float* GetUniformData(const UniformValue& value) const
+        {
+            return reinterpret_cast<const float*>(UniformData.data()) + value.Offset;
+        }
+
+        const float* GetFlippedUniformData(const UniformValue& value) const
+        {
+            return reinterpret_cast<const float*>(FlippedUniformData.data()) + value.FlippedOffset;
+        }
 
-        void SetUniform(bgfx::UniformHandle handle, gsl::span<const float> data, bool YFlip, size_t elementLength = 1)
+        /// Adds a slot for the given uniform if the program does not have one for it yet and returns its index.
+        uint16_t AddUniform(bgfx::UniformHandle handle, bgfx::UniformType::Enum type, uint16_t num, bool YFlip)
         {
-            UniformValue& value = Uniforms[handle.idx];
-            value.Data.assign(data.begin(), data.end());
-            value.ElementLength = static_cast<uint16_t>(elementLength);
+            const auto it = m_uniformSlots.find(handle.idx);
+            if (it != m_uniformSlots.end())
+            {
+                return it->second;
+            }
+
+            const uint16_t elementSize{type == bgfx::UniformType::Mat4 ? uint16_t{16} : type == bgfx::UniformType::Mat3 ? uint16_t{9} : uint16_t{4}};
+            const uint32_t capacity{static_cast<uint32_t>(elementSize) * num};
+            const uint32_t vectorCount{(capacity + 3) / 4};
+
+            UniformValue value{};
+            value.Handle = handle;
+            value.Offset = static_cast<uint32_t>(UniformDataSize());
+            value.Capacity = capacity;
+            value.ElementSize = elementSize;
             value.YFlip = YFlip;
+
+            UniformData.resize(UniformData.size() + vectorCount, bx::simd_zero());
+            if (YFlip)
+            {
+                value.FlippedOffset = static_cast<uint32_t>(FlippedUniformData.size() * 4);
+                FlippedUniformData.resize(FlippedUniformData.size() + vectorCount, bx::simd_zero());
+            }
+
+            const auto slot = gsl::narrow_cast<uint16_t>(Uniforms.size());
+            Uniforms.push_back(value);
+            m_uniformSlots[handle.idx] = slot;
+            return slot;
         }
+
+        /// Copies data into the uniform described by info, calling beforeChange with the uniform's slot first when
+        /// its values change.
+        template<typename BeforeChangeT>
+        void SetUniform(const UniformInfo& info, gsl::span<const float> data, size_t elementLength, BeforeChangeT&& beforeChange)
+        {
+            const auto slot = FindSlot(info);
+            if (slot == UniformInfo::kInvalidSlot)
+            {
+                return;
+            }
+
+            UniformValue& value = Uniforms[slot];
+            const auto length = std::min(static_cast<size_t>(data.size()), static_cast<size_t>(value.Capacity));
+            float* destination = GetUniformData(value);
+            const auto elementCount = static_cast<uint16_t>(std::min(elementLength, static_cast<size_t>(value.Capacity / value.ElementSize)));
+
+            if (value.ElementLength != elementCount || std::memcmp(destination, data.data(), length * sizeof(float)) != 0)
+            {
+                beforeChange(slot);
+                std::memcpy(destination, data.data(), length * sizeof(float));
+                value.ElementLength = elementCount;
+                value.Dirty = true;
+                UpdateFlippedUniform(value);
+            }
+        }
+
+        /// Copies a block of floats into UniformData starting at the given float offset, marking every
+        /// uniform whose values change as dirty and as fully written. beforeChange is called with the slot of each
+        /// of those uniforms before it changes.
+        template<typename BeforeChangeT>
+        void SetUniformBlock(gsl::span<const float> data, size_t offset, BeforeChangeT&& beforeChange)
+        {
+            const auto length = static_cast<size_t>(data.size());
+            if (offset > UniformDataSize() || length > UniformDataSize() - offset)
+            {
+                throw std::runtime_error{"Uniform block exceeds the program's uniform data."};
+            }
+
+            const size_t end = offset + length;
+            for (size_t slot = 0; slot < Uniforms.size(); ++slot)
+            {
+                UniformValue& value = Uniforms[slot];
+                const size_t valueEnd = value.Offset + value.Capacity;
+                if (valueEnd <= offset || value.Offset >= end)
+                {
+                    continue;
+                }
+
+                const size_t first = std::max(static_cast<size_t>(value.Offset), offset);
+                const size_t count = std::min(valueEnd, end) - first;
+                const float* source = data.data() + (first - offset);
+                float* destination = GetUniformData(value) + (first - value.Offset);
+
+                const auto elementCount = static_cast<uint16_t>(value.Capacity / value.ElementSize);
+                if (value.ElementLength != elementCount || std::memcmp(destination, source, count * sizeof(float)) != 0)
+                {
+                    beforeChange(static_cast<uint16_t>(slot));
+                    std::memcpy(destination, source, count * sizeof(float));
+                    value.ElementLength = elementCount;
+                    value.Dirty = true;
+                    UpdateFlippedUniform(value);
+                }
+            }
+        }
+
+        void MarkAllUniformsDirty()
+        {
+            for (auto& value : Uniforms)
+            {
+                value.Dirty = value.ElementLength != 0;
+            }
+        }
+
+        bool HasDirtyUniformsOtherThan(uint16_t slot) const
+        {
+            for (size_t index = 0; index < Uniforms.size(); ++index)
+            {
+                if (Uniforms[index].Dirty && index != slot)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        void UpdateFlippedUniform(const UniformValue& value)
+        {
+            if (!value.YFlip)
+            {
+                return;
+            }
+
+            // Equivalent to multiplying each matrix by a scale of -1 on Y: in bx's row-major layout
+            // that negates the second component of every row, done here by flipping its sign bit.
+            const bx::simd128_t signMask = bx::simd_ild(0, 0x80000000, 0, 0);
+            const auto* source = UniformData.data() + value.Offset / 4;
+            auto* destination = FlippedUniformData.data() + value.FlippedOffset / 4;
+            for (uint32_t row = 0; row < (value.Capacity + 3) / 4; ++row)
+            {
+                bx::simd_st(destination + row, bx::simd_xor(bx::simd_ld(source + row), signMask));
+            }
+        }
+
+        uint16_t FindSlot(const UniformInfo& info) const
+        {
+            // Uniform infos are normally those of this program, but handles are shared between programs
+            // so infos obtained from another program are resolved by handle.
+            if (info.Slot < Uniforms.size() && Uniforms[info.Slot].Handle.idx == info.Handle.idx)
+            {
+                return info.Slot;
+            }
+
+            const auto it = m_uniformSlots.find(info.Handle.idx);
+            return it == m_uniformSlots.end() ? UniformInfo::kInvalidSlot : it->second;
+        }
+
+        std::unordered_map<uint16_t, uint16_t> m_uniformSlots{};
+
+        using ReflectionEntries = std::vector<std::pair<uint32_t, int32_t>>;
+
+        static void AddReflectionEntry(ReflectionEntries& entries, uint32_t nameHash, int32_t value)
+        {
+            entries.emplace_back(nameHash, value);
+        }
+
+        static void SortReflectionEntries(ReflectionEntries& entries)
+        {
+            std::sort(entries.begin(), entries.end());
+
+            // Colliding names keep a single entry so that lookups report them as ambiguous.
+            for (size_t index = 1; index < entries.size(); ++index)
+            {
+                if (entries[index].first == entries[index - 1].first)
+                {
+                    entries[index - 1].second = kReflectionAmbiguous;
+                    entries.erase(entries.begin() + static_cast<ptrdiff_t>(index));
+                    --index;
+                }
+            }
+        }
+
+        static int32_t FindReflectionEntry(const ReflectionEntries& entries, uint32_t nameHash)
+        {
+            const auto it = std::lower_bound(entries.begin(), entries.end(), nameHash, [](const auto& entry, uint32_t hash) {
+                return entry.first < hash;
+            });
+            return (it != entries.end() && it->first == nameHash) ? it->second : kReflectionNotFound;
+        }
+
+        ReflectionEntries m_uniformHashes{};
+        ReflectionEntries m_attributeHashes{};
     };
 
     class IndexBufferData;
     class VertexBufferData;
+    class InstanceBufferData;
+    class OcclusionQueryData;
+    class StorageBufferData;
+
+    /// Shares one bgfx vertex layout handle between all vertex buffer bindings with the same single-attribute
+    /// layout, so that meshes do not each consume one of bgfx's limited vertex layout handles.
+    class VertexLayoutCache final
+    {
+    public:
+        /// Returns the handle for the layout, creating it if no binding currently uses it. Every call must be
+        /// matched by a call to Release.
+        bgfx::VertexLayoutHandle Acquire(bgfx::Attrib::Enum attrib, uint8_t numElements, bgfx::AttribType::Enum attribType, bool normalized, uint16_t stride)
+        {
+            const uint64_t key =
+                static_cast<uint64_t>(attrib) |
+                static_cast<uint64_t>(numElements) << 8 |
+                static_cast<uint64_t>(attribType) << 16 |
+                static_cast<uint64_t>(normalized) << 24 |
+                static_cast<uint64_t>(stride) << 32;
+
+            auto& entry = m_entries[key];
+            if (entry.RefCount++ == 0)
+            {
+                bgfx::VertexLayout vertexLayout{};
+                vertexLayout.begin();
+                vertexLayout.add(attrib, numElements, attribType, normalized);
+                vertexLayout.m_stride = stride;
+                vertexLayout.end();
+
+                entry.Handle = bgfx::createVertexLayout(vertexLayout);
+                m_handleKeys[entry.Handle.idx] = key;
+            }
+
+            return entry.Handle;
+        }
+
+        void Release(bgfx::VertexLayoutHandle handle)
+        {
+            const auto keyIt = m_handleKeys.find(handle.idx);
+            assert(keyIt != m_handleKeys.end());
+
+            const auto entryIt = m_entries.find(keyIt->second);
+            if (--entryIt->second.RefCount == 0)
+            {
+                bgfx::destroy(handle);
+                m_entries.erase(entryIt);
+                m_handleKeys.erase(keyIt);
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            bgfx::VertexLayoutHandle Handle{bgfx::kInvalidHandle};
+            uint32_t RefCount{};
+        };
+
+        std::unordered_map<uint64_t, Entry> m_entries{};
+        std::unordered_map<uint16_t, uint64_t> m_handleKeys{};
+    };
 
     struct VertexArray final
     {
+        explicit VertexArray(VertexLayoutCache& layoutCache)
+            : m_layoutCache{layoutCache}
+        {
+        }
+
         ~VertexArray()
         {
             for (auto& vertexBuffer : vertexBuffers)
             {
-                bgfx::destroy(vertexBuffer.vertexLayoutHandle);
+                m_layoutCache.Release(vertexBuffer.vertexLayoutHandle);
             }
         }
 
@@ -393,10 +958,14 @@ namespace Babylon
         {
             const VertexBufferData* data{};
             uint32_t startVertex{};
+            uint32_t byteStride{};
             bgfx::VertexLayoutHandle vertexLayoutHandle{};
         };
 
         std::vector<VertexBuffer> vertexBuffers{};
+
+    private:
+        VertexLayoutCache& m_layoutCache;
     };
 
     class NativeEngine final : public Napi::ObjectWrap<NativeEngine>
@@ -437,9 +1006,26 @@ namespace Babylon
         void DeleteVertexBuffer(const Napi::CallbackInfo& info);
         void RecordVertexBuffer(const Napi::CallbackInfo& info);
         void UpdateDynamicVertexBuffer(const Napi::CallbackInfo& info);
+        Napi::Value CreateInstanceBuffer(const Napi::CallbackInfo& info);
+        void DeleteInstanceBuffer(const Napi::CallbackInfo& info);
+        void UpdateInstanceBuffer(const Napi::CallbackInfo& info);
         Napi::Value CreateProgram(const Napi::CallbackInfo& info);
         Napi::Value GetUniforms(const Napi::CallbackInfo& info);
+        Napi::Value CreateComputeProgram(const Napi::CallbackInfo& info);
+        Napi::Value GetComputeBindings(const Napi::CallbackInfo& info);
+        Napi::Value CreateStorageBuffer(const Napi::CallbackInfo& info);
+        void DeleteStorageBuffer(const Napi::CallbackInfo& info);
+        void UpdateStorageBuffer(const Napi::CallbackInfo& info);
+        Napi::Value CreateStorageTexture(const Napi::CallbackInfo& info);
+        void SetComputeBuffer(const Napi::CallbackInfo& info);
+        void SetComputeImage(const Napi::CallbackInfo& info);
+        void DispatchCompute(const Napi::CallbackInfo& info);
         Napi::Value GetAttributes(const Napi::CallbackInfo& info);
+        Napi::Value GetUniformOffsets(const Napi::CallbackInfo& info);
+        Napi::Value GetUniformSlots(const Napi::CallbackInfo& info);
+        Napi::Value GetAttributeLocations(const Napi::CallbackInfo& info);
+        const UniformInfo* GetUniformInfo(const Napi::Value& value) const;
+        void SetUniformBlock(const Napi::CallbackInfo& info);
         void SetProgram(const Napi::CallbackInfo& info);
         void SetState(const Napi::CallbackInfo& info);
         void SetZOffset(const Napi::CallbackInfo& info);
@@ -460,6 +1046,7 @@ namespace Babylon
         void SetFloatArray3(const Napi::CallbackInfo& info);
         void SetFloatArray4(const Napi::CallbackInfo& info);
         void SetMatrices(const Napi::CallbackInfo& info);
+        void ComposeWorldMatrices(const Napi::CallbackInfo& info);
         void SetMatrix3x3(const Napi::CallbackInfo& info);
         void SetMatrix2x2(const Napi::CallbackInfo& info);
         void SetFloat(const Napi::CallbackInfo& info);
@@ -483,6 +1070,14 @@ namespace Babylon
         void BindFrameBuffer(const Napi::CallbackInfo& info);
         void UnbindFrameBuffer(const Napi::CallbackInfo& info);
         void DrawIndexed(const Napi::CallbackInfo& info);
+        void DrawIndexedInstanced(const Napi::CallbackInfo& info);
+        Napi::Value CreateOcclusionQuery(const Napi::CallbackInfo& info);
+        void DeleteOcclusionQuery(const Napi::CallbackInfo& info);
+        void BeginOcclusionQuery(const Napi::CallbackInfo& info);
+        void EndOcclusionQuery(const Napi::CallbackInfo& info);
+        Napi::Value GetOcclusionQueryResult(const Napi::CallbackInfo& info);
+        void BeginConditionalRendering(const Napi::CallbackInfo& info);
+        void EndConditionalRendering(const Napi::CallbackInfo& info);
         void Draw(const Napi::CallbackInfo& info);
         void Clear(const Napi::CallbackInfo& info);
         void ClearColor(const Napi::CallbackInfo& info);
@@ -493,6 +1088,41 @@ namespace Babylon
         void SetViewPort(const Napi::CallbackInfo& info);
         void GetFramebufferData(const Napi::CallbackInfo& info);
         Napi::Value GetRenderAPI(const Napi::CallbackInfo& info);
+        void SubmitCommands(const Napi::CallbackInfo& info);
+        Napi::Value GetInstancingStats(const Napi::CallbackInfo& info);
+        void SetViewSortMode(const Napi::CallbackInfo& info);
+        Napi::Value GetViewSortStats(const Napi::CallbackInfo& info);
+        Napi::Value GetResourceStats(const Napi::CallbackInfo& info);
+        Napi::Value GetFrameStats(const Napi::CallbackInfo& info);
+        void SetViewProfilingEnabled(const Napi::CallbackInfo& info);
+        void SetFrameBufferName(const Napi::CallbackInfo& info);
+        void SetTextureStreamingBudget(const Napi::CallbackInfo& info);
+        void SetGpuMipGenerationEnabled(const Napi::CallbackInfo& info);
+        void CullBoundingBoxes(const Napi::CallbackInfo& info);
+        void CullBoundingSpheres(const Napi::CallbackInfo& info);
+
+        // Implementations shared by the individual methods above and by SubmitCommands.
+        void BindVertexArray(const VertexArray& vertexArray);
+        void SetProgram(ProgramData* program);
+        void SetState(bool culling, float zOffset, bool reverseSide);
+        void SetDepthTest(uint32_t depthTest);
+        void SetDepthWrite(bool enable);
+        void SetColorWrite(bool enable);
+        void SetBlendMode(uint64_t blendMode);
+        void SetInt(const UniformInfo* uniformInfo, int32_t value);
+        void SetMatrices(const UniformInfo* uniformInfo, gsl::span<const float> matrices);
+        void SetTextureSampling(TextureData* texture, uint32_t filter);
+        void SetTextureWrapMode(TextureData* texture, uint32_t addressModeU, uint32_t addressModeV, uint32_t addressModeW);
+        void SetTextureAnisotropicLevel(TextureData* texture, uint32_t value);
+        void SetTexture(const UniformInfo* uniformInfo, const TextureData* texture);
+        void ForgetTextureBindings(bgfx::TextureHandle handle);
+        void CreateTextureWithGpuMips(TextureData* texture, bimg::ImageContainer* image);
+        void GenerateQueuedMips();
+        void BindFrameBuffer(FrameBufferData* frameBufferData);
+        void UnbindFrameBuffer(FrameBufferData* frameBufferData);
+        void DrawIndexed(int32_t fillMode, uint32_t elementStart, uint32_t elementCount, const InstanceBufferData* instanceBufferData = nullptr, uint32_t instanceStart = 0, uint32_t instanceCount = 0);
+        void Draw(int32_t fillMode, uint32_t elementStart, uint32_t elementCount);
+        void SetViewPort(float x, float y, float width, float height);
 
         void UpdateSize(size_t width, size_t height);
 
@@ -503,32 +1133,90 @@ namespace Babylon
 
         arcana::cancellation_source m_cancelSource{};
 
+        // Expires when the engine is disposed, for callbacks that can run after that, like finalizers.
+        std::shared_ptr<NativeEngine*> m_lifetime{std::make_shared<NativeEngine*>(this)};
+
         ShaderCompiler m_shaderCompiler;
 
         ProgramData* m_currentProgram{nullptr};
+
+        // What the last draw was submitted with, used to decide which uniforms need to be set again.
+        struct UniformSubmitState
+        {
+            const ProgramData* Program{};
+            uint16_t ProgramHandle{bgfx::kInvalidHandle};
+            bgfx::ViewId ViewId{};
+            uint64_t State{};
+            uint32_t SortDepth{};
+            bool YFlip{false};
+
+            bool operator==(const UniformSubmitState& other) const
+            {
+                return Program == other.Program && ProgramHandle == other.ProgramHandle && ViewId == other.ViewId && State == other.State && SortDepth == other.SortDepth && YFlip == other.YFlip;
+            }
+
+            bool operator!=(const UniformSubmitState& other) const
+            {
+                return !(*this == other);
+            }
+        };
+
+        UniformSubmitState m_lastUniformSubmitState{};
         arcana::weak_table<std::unique_ptr<ProgramData>> m_programDataCollection{};
 
         JsRuntime& m_runtime;
         Graphics::Impl& m_graphicsImpl;
 
+        // Draws issued from JavaScript record into the frame through the default encoder; native work on
+        // other threads records through encoders acquired from m_graphicsImpl.
+        bgfx::Encoder* m_encoder{};
+
+        // Static vertex and index buffers small enough are sub-allocated from these rather than getting bgfx buffers of their own.
+        GeometryHeaps m_geometryHeaps{m_graphicsImpl};
+
+        // Textures loaded with streaming get their larger mips uploaded over the frames after they load.
+        TextureStreamer m_textureStreamer{};
+
+        // Loaded textures whose mips are left to the GPU, each through a frame buffer of its own. bgfx generates the
+        // mips of a frame buffer's textures when the view rendering to it is resolved, so each gets an empty view at
+        // the start of the next frame, before any view that could sample it.
+        struct MipGeneration
+        {
+            bgfx::FrameBufferHandle FrameBuffer{bgfx::kInvalidHandle};
+            uint16_t Width{};
+            uint16_t Height{};
+        };
+        std::vector<MipGeneration> m_mipGenerationQueue{};
+        bool m_gpuMipGeneration{false};
+
         bx::DefaultAllocator m_allocator;
         uint64_t m_engineState;
 
         FrameBufferManager m_frameBufferManager{};
+        VertexLayoutCache m_vertexLayoutCache{};
 
         Plugins::Internal::NativeWindow::NativeWindow::OnResizeCallbackTicket m_resizeCallbackTicket;
 
         template<int size, typename arrayType>
         void SetTypeArrayN(const Napi::CallbackInfo& info);
 
+        template<int size, typename ElementT>
+        void SetTypeArrayN(const UniformInfo* uniformInfo, gsl::span<const ElementT> array);
+
         template<int size>
         void SetFloatN(const Napi::CallbackInfo& info);
 
+        template<int size>
+        void SetFloatN(const UniformInfo* uniformInfo, const float (&values)[4]);
+
         template<int size>
         void SetMatrixN(const Napi::CallbackInfo& info);
 
+        template<int size>
+        void SetMatrixN(const UniformInfo* uniformInfo, gsl::span<const float> matrix);
+
         // Scratch vector used for data alignment.
-        std::vector<float> m_scratch{};
+        std::vector<bx::simd128_t> m_scratch{};
         
         Napi::FunctionReference m_requestAnimationFrameCallback{};
 
@@ -537,5 +1225,77 @@ namespace Babylon
         // at the time of webgl binding, we don't know those values yet
         // so a pointer to the to-bind buffer is kept and the buffer is bound to bgfx at the time of the drawcall
         const IndexBufferData* m_currentBoundIndexBuffer{};
+        const VertexArray* m_currentVertexArray{};
+
+        // A draw with a program that has automatic instancing, held back so that following draws
+        // differing from it only by their world matrix can be merged into one instanced submit.
+        struct PendingDraw
+        {
+            ProgramData* Program{};
+            UniformSubmitState SubmitState{};
+            const VertexArray* BoundVertexArray{};
+            const IndexBufferData* BoundIndexBuffer{};
+            uint32_t ElementStart{};
+            uint32_t ElementCount{};
+            std::vector<float> WorldMatrices{};
+        };
+
+        PendingDraw m_pendingDraw{};
+
+        // Last texture set on each sampler stage, used to tell whether setting a texture would change
+        // the bindings of the pending draw.
+        struct TextureBinding
+        {
+            uint16_t Uniform{bgfx::kInvalidHandle};
+            uint16_t Texture{bgfx::kInvalidHandle};
+            uint32_t Flags{};
+
+            bool operator!=(const TextureBinding& other) const
+            {
+                return Uniform != other.Uniform || Texture != other.Texture || Flags != other.Flags;
+            }
+        };
+
+        std::unordered_map<uint8_t, TextureBinding> m_textureBindings{};
+
+        // Stages the storage buffers and images of the next dispatch are bound to, which the dispatch
+        // hands back to the textures of m_textureBindings.
+        std::vector<uint8_t> m_computeStages{};
+
+        // Order-independent hash of m_textureBindings, used as the sort depth of opaque draws in Auto sorted views
+        // so that bgfx groups draws sharing a program by the textures they use.
+        uint32_t m_textureBindingsKey{};
+
+        // Program and texture of every opaque draw submitted this frame to a view in Auto sort mode, packed as
+        // view id, program handle and texture bindings key, used to count the changes the sorting saved.
+        std::vector<uint64_t> m_autoSortedDraws{};
+
+        // Program and texture changes between consecutive draws avoided by Auto sort mode, since startup.
+        uint64_t m_programChangesSaved{};
+        uint64_t m_textureChangesSaved{};
+
+        void CountAutoSortSavings();
+
+        // Occlusion query the draws are currently submitted with, between beginOcclusionQuery and endOcclusionQuery.
+        bgfx::OcclusionQueryHandle m_activeOcclusionQuery{bgfx::kInvalidHandle};
+
+        // Occlusion query the draws are currently conditional on, and the result they are drawn for.
+        bgfx::OcclusionQueryHandle m_conditionQuery{bgfx::kInvalidHandle};
+        bool m_conditionVisible{true};
+
+        // Draws merged into a previous draw by automatic instancing, and instanced submits made for them.
+        uint32_t m_mergedDrawCount{};
+        uint32_t m_instancedSubmitCount{};
+
+        // Below this many instances left over by FlushPendingDraw, recording them on pooled encoders costs more than it saves.
+        static constexpr uint32_t MinParallelInstanceCount{256};
+
+        void FlushPendingDraw();
+        void SubmitPendingInstancesInParallel(uint32_t firstInstance, uint32_t instanceCount);
+        void SetPendingDrawBindings(bgfx::Encoder* encoder, uint32_t frameIndex) const;
+        void SetUniforms(bgfx::Encoder* encoder, ProgramData& program, bool yFlip);
+        void SetProgramUniform(const UniformInfo& info, gsl::span<const float> data, size_t elementLength = 1);
+        void FlushBeforeUniformChange(const ProgramData& program, uint16_t slot);
+        void Submit(bgfx::Encoder* encoder, bgfx::ViewId viewId, bgfx::ProgramHandle program, uint32_t sortDepth);
     };
 }
@@ -9,4 +9,9 @@ namespace Babylon::Plugins::NativeEngine
     {
         Babylon::NativeEngine::Initialize(env, renderAutomatically);
     }
+
+    ResourceStats GetResourceStats()
+    {
+        return Babylon::GetResourceStats();
+    }
 }
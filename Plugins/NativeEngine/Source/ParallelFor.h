@@ -0,0 +1,76 @@
+#pragma once
+
+#include <arcana/threading/task.h>
+#include <arcana/threading/task_schedulers.h>
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Babylon
+{
+    /// Calls function(begin, end) over chunks covering [0, count), spread across arcana's thread pool, and returns
+    /// once every chunk is done. Chunks hold at least minChunkSize items and start on multiples of chunkAlignment;
+    /// counts that fit in one chunk run on the calling thread alone. The calling thread always takes the first chunk.
+    /// When chunks throw, the first exception is rethrown after every chunk has finished.
+    template<typename FunctionT>
+    void ParallelFor(size_t count, size_t minChunkSize, size_t chunkAlignment, const FunctionT& function)
+    {
+        if (count <= minChunkSize)
+        {
+            function(size_t{0}, count);
+            return;
+        }
+
+        const size_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        const size_t chunkSize = (std::max(minChunkSize, (count + threadCount - 1) / threadCount) + chunkAlignment - 1) / chunkAlignment * chunkAlignment;
+
+        std::vector<arcana::task<void, std::exception_ptr>> tasks{};
+        for (size_t begin = chunkSize; begin < count; begin += chunkSize)
+        {
+            const size_t end = std::min(begin + chunkSize, count);
+            tasks.push_back(arcana::make_task(arcana::threadpool_scheduler, arcana::cancellation::none(), [&function, begin, end]() {
+                function(begin, end);
+            }));
+        }
+
+        // The other chunks reference function, so they are waited on even when this one throws.
+        std::exception_ptr exception{};
+        try
+        {
+            function(size_t{0}, std::min(chunkSize, count));
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+
+        std::mutex mutex{};
+        std::condition_variable completed{};
+        bool done{false};
+        arcana::when_all(gsl::make_span(tasks)).then(arcana::inline_scheduler, arcana::cancellation::none(), [&](const arcana::expected<void, std::exception_ptr>& result) {
+            std::scoped_lock lock{mutex};
+            if (!exception && result.has_error())
+            {
+                exception = result.error();
+            }
+            done = true;
+            completed.notify_one();
+        });
+
+        {
+            std::unique_lock lock{mutex};
+            completed.wait(lock, [&done] { return done; });
+        }
+
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#include "ResourceStats.h"
+
+#include <array>
+#include <atomic>
+
+namespace Babylon
+{
+    namespace
+    {
+        struct AtomicCounter
+        {
+            std::atomic<uint64_t> Count{};
+            std::atomic<uint64_t> Bytes{};
+            std::atomic<uint64_t> PeakCount{};
+            std::atomic<uint64_t> PeakBytes{};
+        };
+
+        std::array<AtomicCounter, static_cast<size_t>(ResourceType::Count)> s_counters{};
+
+        void RaisePeak(std::atomic<uint64_t>& peak, uint64_t value)
+        {
+            uint64_t current = peak.load(std::memory_order_relaxed);
+            while (current < value && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        void Add(ResourceType type, uint64_t count, uint64_t bytes)
+        {
+            auto& counter = s_counters[static_cast<size_t>(type)];
+            RaisePeak(counter.PeakCount, counter.Count.fetch_add(count, std::memory_order_relaxed) + count);
+            RaisePeak(counter.PeakBytes, counter.Bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+        }
+
+        void Remove(ResourceType type, uint64_t count, uint64_t bytes)
+        {
+            auto& counter = s_counters[static_cast<size_t>(type)];
+            counter.Count.fetch_sub(count, std::memory_order_relaxed);
+            counter.Bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        Plugins::NativeEngine::ResourceStats::Counter Load(ResourceType type)
+        {
+            const auto& counter = s_counters[static_cast<size_t>(type)];
+            return {
+                counter.Count.load(std::memory_order_relaxed),
+                counter.Bytes.load(std::memory_order_relaxed),
+                counter.PeakCount.load(std::memory_order_relaxed),
+                counter.PeakBytes.load(std::memory_order_relaxed)};
+        }
+    }
+
+    TrackedResource::~TrackedResource()
+    {
+        if (m_type != ResourceType::Count)
+        {
+            Remove(m_type, 1, m_bytes);
+        }
+    }
+
+    void TrackedResource::Track(ResourceType type, uint64_t bytes)
+    {
+        if (m_type != ResourceType::Count)
+        {
+            Remove(m_type, 1, m_bytes);
+        }
+
+        m_type = type;
+        m_bytes = bytes;
+        Add(type, 1, bytes);
+    }
+
+    Plugins::NativeEngine::ResourceStats GetResourceStats()
+    {
+        Plugins::NativeEngine::ResourceStats stats{};
+        stats.Textures = Load(ResourceType::Texture);
+        stats.IndexBuffers = Load(ResourceType::IndexBuffer);
+        stats.VertexBuffers = Load(ResourceType::VertexBuffer);
+        stats.InstanceBuffers = Load(ResourceType::InstanceBuffer);
+        stats.StorageBuffers = Load(ResourceType::StorageBuffer);
+        stats.FrameBuffers = Load(ResourceType::FrameBuffer);
+        stats.Programs = Load(ResourceType::Program);
+        return stats;
+    }
+}
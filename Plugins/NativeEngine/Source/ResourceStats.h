@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Babylon/Plugins/NativeEngine.h>
+
+#include <cstdint>
+
+namespace Babylon
+{
+    enum class ResourceType
+    {
+        Texture,
+        IndexBuffer,
+        VertexBuffer,
+        InstanceBuffer,
+        StorageBuffer,
+        FrameBuffer,
+        Program,
+        Count,
+    };
+
+    /// Counts the object holding it as one live resource in the totals returned by GetResourceStats, from the first
+    /// call to Track until it is destroyed. Totals are kept in atomics, so resources can come and go on any thread.
+    class TrackedResource final
+    {
+    public:
+        TrackedResource() = default;
+        ~TrackedResource();
+
+        TrackedResource(const TrackedResource&) = delete;
+        TrackedResource& operator=(const TrackedResource&) = delete;
+
+        /// Starts counting the resource as type, or changes its bytes if it is already counted.
+        void Track(ResourceType type, uint64_t bytes);
+
+        uint64_t GetBytes() const
+        {
+            return m_bytes;
+        }
+
+    private:
+        ResourceType m_type{ResourceType::Count};
+        uint64_t m_bytes{};
+    };
+
+    Plugins::NativeEngine::ResourceStats GetResourceStats();
+}
@@ -30,6 +30,22 @@ namespace Babylon
             std::unordered_map<std::string, uint8_t> FragmentUniformStages{};
         };
 
-        BgfxShaderInfo Compile(std::string_view vertexSource, std::string_view fragmentSource);
+        /// Compiles a vertex and fragment shader pair. If instancedWorldMatrix is true, the vertex
+        /// shader's world matrix uniform is replaced with per-instance data (see
+        /// ShaderCompilerTraversers::MoveWorldUniformIntoInstanceAttributes).
+        BgfxShaderInfo Compile(std::string_view vertexSource, std::string_view fragmentSource, bool instancedWorldMatrix = false);
+
+        struct BgfxComputeShaderInfo
+        {
+            std::vector<uint8_t> ComputeBytes{};
+            std::unordered_map<std::string, uint8_t> ComputeUniformStages{};
+
+            /// Stages to bind the shader's storage buffers and images to, by name. These are the
+            /// bindings declared in the source, which must not collide with the stages of its samplers.
+            std::unordered_map<std::string, uint8_t> ComputeStorageStages{};
+        };
+
+        /// Compiles a compute shader.
+        BgfxComputeShaderInfo CompileCompute(std::string_view computeSource);
     };
 }
@@ -69,6 +69,20 @@ namespace Babylon::ShaderCompilerCommon
         }
     }
 
+    void CollectStorageStages(const spirv_cross::Compiler& compiler, const spirv_cross::SmallVector<spirv_cross::Resource>& resources, std::unordered_map<std::string, uint8_t>& stages)
+    {
+        for (const spirv_cross::Resource& resource : resources)
+        {
+            const uint32_t binding = compiler.get_decoration(resource.id, spv::DecorationBinding);
+            if (binding > UINT8_MAX)
+            {
+                throw std::runtime_error{"Storage binding of " + resource.name + " is out of range."};
+            }
+
+            stages[resource.name] = static_cast<uint8_t>(binding);
+        }
+    }
+
     NonSamplerUniformsInfo CollectNonSamplerUniforms(spirv_cross::Parser& parser, const spirv_cross::Compiler& compiler)
     {
         NonSamplerUniformsInfo info{};
@@ -219,6 +233,16 @@ namespace Babylon::ShaderCompilerCommon
                     attributeName = "matricesIndices";
                 else if (attributeName == "a_weight")
                     attributeName = "matricesWeights";
+                else if (attributeName == "i_data0")
+                    attributeName = "world0";
+                else if (attributeName == "i_data1")
+                    attributeName = "world1";
+                else if (attributeName == "i_data2")
+                    attributeName = "world2";
+                else if (attributeName == "i_data3")
+                    attributeName = "world3";
+                else if (attributeName == "i_data4")
+                    attributeName = "instanceColor";
 
                 bgfxShaderInfo.VertexAttributeLocations[attributeName] = location;
             }
@@ -262,4 +286,59 @@ namespace Babylon::ShaderCompilerCommon
 
         return bgfxShaderInfo;
     }
+
+    ShaderCompiler::BgfxComputeShaderInfo CreateBgfxComputeShader(ShaderInfo computeShaderInfo)
+    {
+        ShaderCompiler::BgfxComputeShaderInfo bgfxShaderInfo{};
+
+        constexpr uint8_t BGFX_SHADER_BIN_VERSION = 6;
+
+        // Compute shaders have no stage to link with, so these only have to be present.
+        constexpr uint32_t inputsHash = 0xBAD1DEA;
+        constexpr uint32_t outputsHash = inputsHash;
+
+        std::vector<uint8_t>& computeBytes{bgfxShaderInfo.ComputeBytes};
+
+        const spirv_cross::Compiler& compiler = *computeShaderInfo.Compiler;
+        const spirv_cross::ShaderResources resources = compiler.get_shader_resources();
+        const auto uniformsInfo = CollectNonSamplerUniforms(*computeShaderInfo.Parser, compiler);
+#if __APPLE__
+        const spirv_cross::SmallVector<spirv_cross::Resource>& samplers = resources.separate_images;
+#elif APIOpenGL
+        const spirv_cross::SmallVector<spirv_cross::Resource>& samplers = resources.sampled_images;
+#else
+        const spirv_cross::SmallVector<spirv_cross::Resource>& samplers = resources.separate_samplers;
+#endif
+        size_t numUniforms = uniformsInfo.Uniforms.size() + samplers.size();
+
+        AppendBytes(computeBytes, BX_MAKEFOURCC('C', 'S', 'H', BGFX_SHADER_BIN_VERSION));
+        AppendBytes(computeBytes, inputsHash);
+        AppendBytes(computeBytes, outputsHash);
+
+        AppendBytes(computeBytes, static_cast<uint16_t>(numUniforms));
+        AppendUniformBuffer(computeBytes, uniformsInfo, false);
+        AppendSamplers(computeBytes, compiler, samplers, bgfxShaderInfo.ComputeUniformStages);
+
+        AppendBytes(computeBytes, static_cast<uint32_t>(computeShaderInfo.Bytes.size()));
+        AppendBytes(computeBytes, computeShaderInfo.Bytes);
+        AppendBytes(computeBytes, static_cast<uint8_t>(0));
+
+#if (BGFX_CONFIG_RENDERER_METAL)
+        // Metal takes the thread group size at dispatch rather than from the shader.
+        for (uint32_t dimension = 0; dimension < 3; ++dimension)
+        {
+            AppendBytes(computeBytes, static_cast<uint16_t>(compiler.get_execution_mode_argument(spv::ExecutionModeLocalSize, dimension)));
+        }
+#endif
+
+        // Compute shaders don't have attributes.
+        AppendBytes(computeBytes, static_cast<uint8_t>(0));
+
+        AppendBytes(computeBytes, static_cast<uint16_t>(uniformsInfo.ByteSize));
+
+        CollectStorageStages(compiler, resources.storage_buffers, bgfxShaderInfo.ComputeStorageStages);
+        CollectStorageStages(compiler, resources.storage_images, bgfxShaderInfo.ComputeStorageStages);
+
+        return bgfxShaderInfo;
+    }
 }
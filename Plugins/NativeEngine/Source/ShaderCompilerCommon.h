@@ -54,6 +54,7 @@ namespace Babylon::ShaderCompilerCommon
 
     void AppendUniformBuffer(std::vector<uint8_t>& bytes, const NonSamplerUniformsInfo& uniformBuffer, bool isFragment);
     void AppendSamplers(std::vector<uint8_t>& bytes, const spirv_cross::Compiler& compiler, const spirv_cross::SmallVector<spirv_cross::Resource>& samplers, std::unordered_map<std::string, uint8_t>& stages);
+    void CollectStorageStages(const spirv_cross::Compiler& compiler, const spirv_cross::SmallVector<spirv_cross::Resource>& resources, std::unordered_map<std::string, uint8_t>& stages);
     NonSamplerUniformsInfo CollectNonSamplerUniforms(spirv_cross::Parser& parser, const spirv_cross::Compiler& compiler);
 
     struct ShaderInfo
@@ -64,4 +65,5 @@ namespace Babylon::ShaderCompilerCommon
     };
 
     ShaderCompiler::BgfxShaderInfo CreateBgfxShader(ShaderInfo vertexShaderInfo, ShaderInfo fragmentShaderInfo);
+    ShaderCompiler::BgfxComputeShaderInfo CreateBgfxComputeShader(ShaderInfo computeShaderInfo);
 }
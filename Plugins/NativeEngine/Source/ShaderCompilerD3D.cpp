@@ -38,7 +38,8 @@ namespace Babylon
 
             auto compiler = std::make_unique<spirv_cross::CompilerHLSL>(parser->get_parsed_ir());
 
-            compiler->set_hlsl_options({40, true});
+            // Compute shaders need shader model 5.
+            compiler->set_hlsl_options({stage == EShLangCompute ? 50u : 40u, true});
 
             for (const auto& attribute : attributes)
             {
@@ -48,7 +49,7 @@ namespace Babylon
             std::string hlsl = compiler->compile();
 
             Microsoft::WRL::ComPtr<ID3DBlob> errorMsgs;
-            const char* target = stage == EShLangVertex ? "vs_4_0" : "ps_4_0";
+            const char* target = stage == EShLangVertex ? "vs_4_0" : stage == EShLangFragment ? "ps_4_0" : "cs_5_0";
 
             UINT flags = 0;
 
@@ -75,7 +76,7 @@ namespace Babylon
         glslang::FinalizeProcess();
     }
 
-    ShaderCompiler::BgfxShaderInfo ShaderCompiler::Compile(std::string_view vertexSource, std::string_view fragmentSource)
+    ShaderCompiler::BgfxShaderInfo ShaderCompiler::Compile(std::string_view vertexSource, std::string_view fragmentSource, bool instancedWorldMatrix)
     {
         glslang::TProgram program;
 
@@ -96,6 +97,10 @@ namespace Babylon
         }
 
         ShaderCompilerTraversers::IdGenerator ids{};
+        if (instancedWorldMatrix)
+        {
+            ShaderCompilerTraversers::MoveWorldUniformIntoInstanceAttributes(program, ids);
+        }
         auto utstScope = ShaderCompilerTraversers::MoveNonSamplerUniformsIntoStruct(program, ids);
         ShaderCompilerTraversers::AssignLocationsAndNamesToVertexVaryings(program, ids);
         ShaderCompilerTraversers::SplitSamplersIntoSamplersAndTextures(program, ids);
@@ -136,4 +141,42 @@ namespace Babylon
 
         return ShaderCompilerCommon::CreateBgfxShader(std::move(vertexShaderInfo), std::move(fragmentShaderInfo));
     }
+
+    ShaderCompiler::BgfxComputeShaderInfo ShaderCompiler::CompileCompute(std::string_view computeSource)
+    {
+        glslang::TProgram program;
+
+        glslang::TShader computeShader{EShLangCompute};
+        AddShader(program, computeShader, computeSource);
+
+        glslang::SpvVersion spv{};
+        spv.spv = 0x10000;
+        computeShader.getIntermediate()->setSpv(spv);
+
+        if (!program.link(EShMsgDefault))
+        {
+            throw std::exception(program.getInfoDebugLog());
+        }
+
+        ShaderCompilerTraversers::IdGenerator ids{};
+        auto utstScope = ShaderCompilerTraversers::MoveNonSamplerUniformsIntoStruct(program, ids);
+        ShaderCompilerTraversers::SplitSamplersIntoSamplersAndTextures(program, ids);
+
+        Microsoft::WRL::ComPtr<ID3DBlob> computeBlob;
+        auto [computeParser, computeCompiler] = CompileShader(program, EShLangCompute, {}, &computeBlob);
+
+        // spirv-cross turns storage buffers into byte address buffers, which need raw views, but bgfx's
+        // Direct3D 11 renderer only creates typed views of compute buffers.
+        if (!computeCompiler->get_shader_resources().storage_buffers.empty())
+        {
+            throw std::runtime_error{"Storage buffers are not supported by Direct3D compute shaders; use storage images instead."};
+        }
+
+        ShaderCompilerCommon::ShaderInfo computeShaderInfo{
+            std::move(computeParser),
+            std::move(computeCompiler),
+            gsl::make_span(static_cast<uint8_t*>(computeBlob->GetBufferPointer()), computeBlob->GetBufferSize())};
+
+        return ShaderCompilerCommon::CreateBgfxComputeShader(std::move(computeShaderInfo));
+    }
 }
@@ -50,7 +50,7 @@ namespace Babylon
                     compiler->set_decoration(output.id, spv::DecorationLocation, -1);
                 }
             }
-            else
+            else if (stage == EShLangFragment)
             {
               for (auto& input : resources.stage_inputs)
                 {
@@ -69,7 +69,32 @@ namespace Babylon
                 }
             }
             
-            compiler->rename_entry_point("main", "xlatMtlMain", (stage == EShLangVertex) ? spv::ExecutionModelVertex : spv::ExecutionModelFragment);
+            // bgfx binds compute buffers after the uniform buffer and compute images on the texture of their stage.
+            if (stage == EShLangCompute)
+            {
+                for (auto& resource : resources.storage_buffers)
+                {
+                    spirv_cross::MSLResourceBinding binding{};
+                    binding.stage = spv::ExecutionModelGLCompute;
+                    binding.desc_set = compiler->get_decoration(resource.id, spv::DecorationDescriptorSet);
+                    binding.binding = compiler->get_decoration(resource.id, spv::DecorationBinding);
+                    binding.msl_buffer = binding.binding + 1;
+                    compiler->add_msl_resource_binding(binding);
+                }
+
+                for (auto& resource : resources.storage_images)
+                {
+                    spirv_cross::MSLResourceBinding binding{};
+                    binding.stage = spv::ExecutionModelGLCompute;
+                    binding.desc_set = compiler->get_decoration(resource.id, spv::DecorationDescriptorSet);
+                    binding.binding = compiler->get_decoration(resource.id, spv::DecorationBinding);
+                    binding.msl_texture = binding.binding;
+                    compiler->add_msl_resource_binding(binding);
+                }
+            }
+
+            const auto executionModel = stage == EShLangVertex ? spv::ExecutionModelVertex : stage == EShLangFragment ? spv::ExecutionModelFragment : spv::ExecutionModelGLCompute;
+            compiler->rename_entry_point("main", "xlatMtlMain", executionModel);
 
             shaderResult = compiler->compile();
             return{std::move(parser), std::move(compiler)};
@@ -89,7 +114,7 @@ namespace Babylon
         glslang::FinalizeProcess();
     }
 
-    ShaderCompiler::BgfxShaderInfo ShaderCompiler::Compile(std::string_view vertexSource, std::string_view fragmentSource)
+    ShaderCompiler::BgfxShaderInfo ShaderCompiler::Compile(std::string_view vertexSource, std::string_view fragmentSource, bool instancedWorldMatrix)
     {
         glslang::TProgram program;
 
@@ -110,6 +135,10 @@ namespace Babylon
         }
 
         ShaderCompilerTraversers::IdGenerator ids{};
+        if (instancedWorldMatrix)
+        {
+            ShaderCompilerTraversers::MoveWorldUniformIntoInstanceAttributes(program, ids);
+        }
         auto cutScope = ShaderCompilerTraversers::ChangeUniformTypes(program, ids);
         auto utstScope = ShaderCompilerTraversers::MoveNonSamplerUniformsIntoStruct(program, ids);
         ShaderCompilerTraversers::AssignLocationsAndNamesToVertexVaryings(program, ids);
@@ -126,4 +155,32 @@ namespace Babylon
             {std::move(vertexParser), std::move(vertexCompiler), gsl::make_span(reinterpret_cast<uint8_t*>(vertexGLSL.data()), vertexGLSL.size())},
             {std::move(fragmentParser), std::move(fragmentCompiler), gsl::make_span(reinterpret_cast<uint8_t*>(fragmentGLSL.data()), fragmentGLSL.size())});
     }
+
+    ShaderCompiler::BgfxComputeShaderInfo ShaderCompiler::CompileCompute(std::string_view computeSource)
+    {
+        glslang::TProgram program;
+
+        glslang::TShader computeShader{EShLangCompute};
+        AddShader(program, computeShader, computeSource);
+
+        glslang::SpvVersion spv{};
+        spv.spv = 0x10000;
+        computeShader.getIntermediate()->setSpv(spv);
+
+        if (!program.link(EShMsgDefault))
+        {
+            throw std::exception();
+        }
+
+        ShaderCompilerTraversers::IdGenerator ids{};
+        auto cutScope = ShaderCompilerTraversers::ChangeUniformTypes(program, ids);
+        auto utstScope = ShaderCompilerTraversers::MoveNonSamplerUniformsIntoStruct(program, ids);
+        ShaderCompilerTraversers::SplitSamplersIntoSamplersAndTextures(program, ids);
+
+        std::string computeMSL(computeSource.data(), computeSource.size());
+        auto [computeParser, computeCompiler] = CompileShader(program, EShLangCompute, computeMSL);
+
+        return ShaderCompilerCommon::CreateBgfxComputeShader(
+            {std::move(computeParser), std::move(computeCompiler), gsl::make_span(reinterpret_cast<uint8_t*>(computeMSL.data()), computeMSL.size())});
+    }
 }
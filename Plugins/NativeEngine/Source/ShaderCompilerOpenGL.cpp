@@ -39,7 +39,8 @@ namespace Babylon
 
             spirv_cross::CompilerGLSL::Options options = compiler->get_common_options();
 
-            options.version = 300;
+            // Compute shaders need OpenGL ES 3.1.
+            options.version = stage == EShLangCompute ? 310 : 300;
             options.es = true;
 
             compiler->set_common_options(options);
@@ -60,7 +61,7 @@ namespace Babylon
         glslang::FinalizeProcess();
     }
 
-    ShaderCompiler::BgfxShaderInfo ShaderCompiler::Compile(std::string_view vertexSource, std::string_view fragmentSource)
+    ShaderCompiler::BgfxShaderInfo ShaderCompiler::Compile(std::string_view vertexSource, std::string_view fragmentSource, bool instancedWorldMatrix)
     {
         glslang::TProgram program;
 
@@ -81,6 +82,10 @@ namespace Babylon
         }
 
         ShaderCompilerTraversers::IdGenerator ids{};
+        if (instancedWorldMatrix)
+        {
+            ShaderCompilerTraversers::MoveWorldUniformIntoInstanceAttributes(program, ids);
+        }
         auto cutScope = ShaderCompilerTraversers::ChangeUniformTypes(program, ids);
         ShaderCompilerTraversers::AssignLocationsAndNamesToVertexVaryings(program, ids);
 
@@ -94,4 +99,30 @@ namespace Babylon
             {std::move(vertexParser), std::move(vertexCompiler), gsl::make_span(reinterpret_cast<uint8_t*>(vertexGLSL.data()), vertexGLSL.size())},
             {std::move(fragmentParser), std::move(fragmentCompiler), gsl::make_span(reinterpret_cast<uint8_t*>(fragmentGLSL.data()), fragmentGLSL.size())});
     }
+
+    ShaderCompiler::BgfxComputeShaderInfo ShaderCompiler::CompileCompute(std::string_view computeSource)
+    {
+        glslang::TProgram program;
+
+        glslang::TShader computeShader{EShLangCompute};
+        AddShader(program, computeShader, computeSource);
+
+        glslang::SpvVersion spv{};
+        spv.spv = 0x10000;
+        computeShader.getIntermediate()->setSpv(spv);
+
+        if (!program.link(EShMsgDefault))
+        {
+            throw std::exception();
+        }
+
+        ShaderCompilerTraversers::IdGenerator ids{};
+        auto cutScope = ShaderCompilerTraversers::ChangeUniformTypes(program, ids);
+
+        std::string computeGLSL(computeSource.data(), computeSource.size());
+        auto [computeParser, computeCompiler] = CompileShader(program, EShLangCompute, computeGLSL);
+
+        return ShaderCompilerCommon::CreateBgfxComputeShader(
+            {std::move(computeParser), std::move(computeCompiler), gsl::make_span(reinterpret_cast<uint8_t*>(computeGLSL.data()), computeGLSL.size())});
+    }
 }
@@ -80,6 +80,22 @@ namespace Babylon::ShaderCompilerTraversers
             return agg && agg->getOp() == EOpLinkerObjects;
         }
 
+        /// Helper method to run a traversal over every stage of a program that has uniforms,
+        /// which is either the vertex and fragment stages or the compute stage.
+        /// @param program The program to traverse.
+        /// @param traverse Callable invoked with the intermediate of each stage present.
+        template<typename TraverseT>
+        void forEachUniformStage(TProgram& program, TraverseT traverse)
+        {
+            for (const auto stage : {EShLangVertex, EShLangFragment, EShLangCompute})
+            {
+                if (auto* intermediate = program.getIntermediate(stage))
+                {
+                    traverse(intermediate);
+                }
+            }
+        }
+
         /// This traverser collects all non-sampler uniforms and creates a new struct
         /// called "Frame" to contain them. This is necessary to correctly transpile
         /// for DirectX and Metal.
@@ -89,8 +105,7 @@ namespace Babylon::ShaderCompilerTraversers
             static ScopeT Traverse(TProgram& program, IdGenerator& ids)
             {
                 auto* scope = new AllocationsScope();
-                Traverse(program.getIntermediate(EShLangVertex), ids, *scope);
-                Traverse(program.getIntermediate(EShLangFragment), ids, *scope);
+                forEachUniformStage(program, [&](TIntermediate* intermediate) { Traverse(intermediate, ids, *scope); });
                 return std::unique_ptr<AllocationsScopeBase>(scope);
             }
 
@@ -110,7 +125,7 @@ namespace Babylon::ShaderCompilerTraversers
             virtual void visitSymbol(TIntermSymbol* symbol) override
             {
                 // Collect all non-sampler uniforms and add the to the list of elements to process.
-                if (symbol->getType().getQualifier().isUniformOrBuffer() && symbol->getType().getBasicType() != EbtSampler)
+                if (symbol->getType().getQualifier().storage == EvqUniform && symbol->getType().getBasicType() != EbtSampler)
                 {
                     // Linker objects are treated differently by this traverser because unlike ordinary
                     // symbols which should simply be replaced with their struct members, the linker
@@ -259,8 +274,7 @@ namespace Babylon::ShaderCompilerTraversers
             static ScopeT Traverse(TProgram& program, IdGenerator& ids)
             {
                 auto* scope = new AllocationsScope();
-                Traverse(program.getIntermediate(EShLangVertex), ids, *scope);
-                Traverse(program.getIntermediate(EShLangFragment), ids, *scope);
+                forEachUniformStage(program, [&](TIntermediate* intermediate) { Traverse(intermediate, ids, *scope); });
                 return std::unique_ptr<AllocationsScopeBase>(scope);
             }
 
@@ -286,7 +300,7 @@ namespace Babylon::ShaderCompilerTraversers
                 auto& type = symbol->getType();
 
                 // We only care about uniforms that are neither samplers nor matrices.
-                if (type.getQualifier().isUniformOrBuffer() && type.getBasicType() != EbtSampler && !type.isMatrix())
+                if (type.getQualifier().storage == EvqUniform && type.getBasicType() != EbtSampler && !type.isMatrix())
                 {
                     // At present, this may end up creating layered swizzles; i.e., if a vec3 was already being projected 
                     // down a la vec3.x, greedily adding a swizzle operator to deal with the new type mismatch may create 
@@ -413,6 +427,112 @@ namespace Babylon::ShaderCompilerTraversers
             AllocationsScope& m_scope;
         };
 
+        /// This traverser replaces the world matrix uniform of the vertex shader with a
+        /// matrix built from the instance data attributes provided by bgfx. It is used to
+        /// create the instanced variant of programs that opt into automatic instancing.
+        class WorldUniformToInstanceAttributesTraverser final : private TIntermTraverser
+        {
+        public:
+            static void Traverse(TProgram& program, IdGenerator& ids)
+            {
+                Traverse(program.getIntermediate(EShLangVertex), ids);
+            }
+
+        private:
+            virtual void visitSymbol(TIntermSymbol* symbol) override
+            {
+                const auto& type = symbol->getType();
+                if (type.getQualifier().isUniformOrBuffer() && type.isMatrix() && !type.isArray() && std::strcmp(symbol->getName().c_str(), "world") == 0)
+                {
+                    if (isLinkerObject(this->path))
+                    {
+                        m_linkerSymbol = symbol;
+                    }
+                    else
+                    {
+                        m_symbolsToParents.emplace_back(symbol, this->getParentNode());
+                    }
+                }
+            }
+
+            static void Traverse(TIntermediate* intermediate, IdGenerator& ids)
+            {
+                WorldUniformToInstanceAttributesTraverser traverser{};
+                intermediate->getTreeRoot()->traverse(&traverser);
+
+                if (traverser.m_linkerSymbol == nullptr)
+                {
+                    return;
+                }
+
+                TSourceLoc loc{};
+                loc.init();
+
+                // The four columns of the matrix, as vertex attributes. Ordinary symbols and linker
+                // objects get distinct nodes for the same variables, as they would when parsed.
+                TPublicType attributePublicType{};
+                attributePublicType.qualifier.clearLayout();
+                attributePublicType.qualifier.storage = EvqVaryingIn;
+                attributePublicType.qualifier.precision = EpqHigh;
+                attributePublicType.basicType = EbtFloat;
+                attributePublicType.setVector(4);
+                const TType attributeType{attributePublicType};
+
+                constexpr std::array<const char*, 4> attributeNames{"i_data0", "i_data1", "i_data2", "i_data3"};
+                std::array<int, 4> attributeIds{};
+                for (size_t idx = 0; idx < attributeNames.size(); ++idx)
+                {
+                    attributeIds[idx] = ids.Next();
+                }
+
+                const auto newAttribute = [&](size_t idx) {
+                    return intermediate->addSymbol(TIntermSymbol{attributeIds[idx], attributeNames[idx], attributeType});
+                };
+
+                // Create the operation constructing the matrix from its columns.
+                auto* constructor = intermediate->growAggregate(newAttribute(0), newAttribute(1));
+                constructor = intermediate->growAggregate(constructor, newAttribute(2));
+                constructor = intermediate->growAggregate(constructor, newAttribute(3));
+                {
+                    const auto& worldType = traverser.m_linkerSymbol->getType();
+
+                    TPublicType publicType{};
+                    publicType.qualifier.clearLayout();
+                    publicType.qualifier.storage = EvqTemporary;
+                    publicType.qualifier.precision = EpqHigh;
+                    publicType.basicType = EbtFloat;
+                    publicType.setMatrix(worldType.getMatrixCols(), worldType.getMatrixRows());
+
+                    constructor->setOperator(EOpConstructMat4x4);
+                    constructor->setType(TType{publicType});
+                }
+
+                // Swap the uniform for the attributes in the linker objects.
+                auto* linkerObjectAggregate = intermediate->getTreeRoot()->getAsAggregate()->getSequence().back()->getAsAggregate();
+                assert(linkerObjectAggregate->getOp() == EOpLinkerObjects);
+                auto& sequence = linkerObjectAggregate->getSequence();
+                for (int idx = gsl::narrow_cast<int>(sequence.size()) - 1; idx >= 0; --idx)
+                {
+                    if (sequence[idx] == traverser.m_linkerSymbol)
+                    {
+                        RemoveAllTreeNodes(traverser.m_linkerSymbol);
+                        sequence.erase(sequence.begin() + idx);
+                    }
+                }
+                for (size_t idx = 0; idx < attributeNames.size(); ++idx)
+                {
+                    sequence.push_back(newAttribute(idx));
+                }
+
+                std::map<std::string, TIntermTyped*> nameToReplacement{};
+                nameToReplacement["world"] = constructor;
+                makeReplacements(nameToReplacement, traverser.m_symbolsToParents);
+            }
+
+            TIntermSymbol* m_linkerSymbol{};
+            std::vector<std::pair<TIntermSymbol*, TIntermNode*>> m_symbolsToParents{};
+        };
+
         /// This traverser modifies all vertex attributes (position, UV, etc.) to conform to
         /// bgfx's expectations regarding name and location. It is currently required for
         /// DirectX, OpenGL, and Metal.
@@ -463,6 +583,19 @@ namespace Babylon::ShaderCompilerTraversers
                 IF_NAME_RETURN_ATTRIB("color", bgfx::Attrib::Color0, "a_color0")
                 IF_NAME_RETURN_ATTRIB("matricesIndices", bgfx::Attrib::Indices, "a_indices")
                 IF_NAME_RETURN_ATTRIB("matricesWeights", bgfx::Attrib::Weight, "a_weight")
+                IF_NAME_RETURN_ATTRIB("i_data0", bgfx::Attrib::TexCoord7, "i_data0")
+                IF_NAME_RETURN_ATTRIB("i_data1", bgfx::Attrib::TexCoord6, "i_data1")
+                IF_NAME_RETURN_ATTRIB("i_data2", bgfx::Attrib::TexCoord5, "i_data2")
+                IF_NAME_RETURN_ATTRIB("i_data3", bgfx::Attrib::TexCoord4, "i_data3")
+                // Babylon's per-instance attributes are fed from instance data buffers, which bgfx
+                // binds to the same texture coordinate slots it reserves for i_data0 through i_data4.
+                // Like bgfx's own i_data4, instanceColor shares its slot with uv4, so Traverse rejects
+                // shaders that use both.
+                IF_NAME_RETURN_ATTRIB("world0", bgfx::Attrib::TexCoord7, "i_data0")
+                IF_NAME_RETURN_ATTRIB("world1", bgfx::Attrib::TexCoord6, "i_data1")
+                IF_NAME_RETURN_ATTRIB("world2", bgfx::Attrib::TexCoord5, "i_data2")
+                IF_NAME_RETURN_ATTRIB("world3", bgfx::Attrib::TexCoord4, "i_data3")
+                IF_NAME_RETURN_ATTRIB("instanceColor", bgfx::Attrib::TexCoord3, "i_data4")
 #undef IF_NAME_RETURN_ATTRIB
                 return {FIRST_GENERIC_ATTRIBUTE_LOCATION + m_genericAttributesRunningCount++, name};
             }
@@ -480,6 +613,11 @@ namespace Babylon::ShaderCompilerTraversers
                 TPublicType publicType{};
                 publicType.qualifier.clearLayout();
 
+                if (traverser.m_varyingNameToSymbol.count("uv4") != 0 && traverser.m_varyingNameToSymbol.count("instanceColor") != 0)
+                {
+                    throw std::runtime_error{"Vertex attributes uv4 and instanceColor cannot be used together: both are bound to texture coordinate 3."};
+                }
+
                 // UVs are effectively a special kind of generic attribute since they both use
                 // are implemented using texture coordinates, so we preprocess to pre-count the
                 // number of UV coordinate variables to prevent collisions.
@@ -537,7 +675,7 @@ namespace Babylon::ShaderCompilerTraversers
         public:
             void visitSymbol(TIntermSymbol* symbol) override
             {
-                if (symbol->getType().getQualifier().storage == EvqUniform && symbol->getType().getBasicType() == EbtSampler)
+                if (symbol->getType().getQualifier().storage == EvqUniform && symbol->getType().getBasicType() == EbtSampler && !symbol->getType().getSampler().isImage())
                 {
                     // Collect all sampler uniform symbols into the relevant caches 
                     // later proccessing. Note that we treat linker object replacement
@@ -556,8 +694,7 @@ namespace Babylon::ShaderCompilerTraversers
 
             static void Traverse(TProgram& program, IdGenerator& ids)
             {
-                Traverse(program.getIntermediate(EShLangVertex), ids);
-                Traverse(program.getIntermediate(EShLangFragment), ids);
+                forEachUniformStage(program, [&](TIntermediate* intermediate) { Traverse(intermediate, ids); });
             }
 
         private:
@@ -712,6 +849,11 @@ namespace Babylon::ShaderCompilerTraversers
         return UniformTypeChangeTraverser::Traverse(program, ids);
     }
 
+    void MoveWorldUniformIntoInstanceAttributes(TProgram& program, IdGenerator& ids)
+    {
+        WorldUniformToInstanceAttributesTraverser::Traverse(program, ids);
+    }
+
     void AssignLocationsAndNamesToVertexVaryings(TProgram& program, IdGenerator& ids)
     {
         VertexVaryingInTraverser::Traverse(program, ids);
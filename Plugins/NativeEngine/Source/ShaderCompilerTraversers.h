@@ -64,6 +64,17 @@ namespace Babylon::ShaderCompilerTraversers
     /// that all uniforms, even scalars, are implemented as vec4 uniforms.
     ScopeT ChangeUniformTypes(glslang::TProgram& program, IdGenerator& ids);
 
+    /// Replaces the "world" matrix uniform of the vertex shader with a matrix assembled
+    /// from the per-instance attributes i_data0 through i_data3, which is how bgfx feeds
+    /// instance data buffers to shaders. Thus, if the input vertex shader contains
+    ///
+    ///     uniform mat4 world;
+    ///
+    /// then every use of world will be replaced with mat4(i_data0, i_data1, i_data2, i_data3).
+    /// Must be done before uniforms are moved or retyped and before vertex varyings are
+    /// assigned their locations.
+    void MoveWorldUniformIntoInstanceAttributes(glslang::TProgram& program, IdGenerator& ids);
+
     /// Changes the names and locations of varying attributes in the vertex shader to
     /// match bgfx's expectations. 
     void AssignLocationsAndNamesToVertexVaryings(glslang::TProgram& program, IdGenerator& ids);
@@ -71,7 +82,7 @@ namespace Babylon::ShaderCompilerTraversers
     /// WebGL (and therefore Babylon.js) treats texture samplers as a single variable. 
     /// Native platforms expect them to be two separate variables -- a texture and a 
     /// sampler -- used together, so this function splits all texture samplers to match
-    /// the expectations of native platforms.
+    /// the expectations of native platforms. Storage images are left as they are.
     void SplitSamplersIntoSamplersAndTextures(glslang::TProgram& program, IdGenerator& ids);
 
     /// Invert dFdy operands similar to bgfx_shader.sh
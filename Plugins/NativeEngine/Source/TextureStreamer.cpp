@@ -0,0 +1,158 @@
+#include "TextureStreamer.h"
+#include "NativeEngine.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Babylon
+{
+    namespace
+    {
+        constexpr uint64_t TextureFlags{BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE};
+
+        bimg::ImageMip GetMip(const bimg::ImageContainer& image, uint8_t mip)
+        {
+            bimg::ImageMip imageMip{};
+            bimg::imageGetRawData(image, 0, mip, image.m_data, image.m_size, imageMip);
+            return imageMip;
+        }
+
+        uint8_t CompleteMipCount(uint32_t width, uint32_t height)
+        {
+            uint8_t count{1};
+            for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+            {
+                ++count;
+            }
+            return count;
+        }
+    }
+
+    TextureStreamer::~TextureStreamer()
+    {
+        Clear();
+    }
+
+    bool TextureStreamer::CanStream(const bimg::ImageContainer& image)
+    {
+        return !image.m_cubeMap &&
+            image.m_numLayers == 1 &&
+            image.m_depth == 1 &&
+            std::max(image.m_width, image.m_height) > InitialMipSize &&
+            image.m_numMips == CompleteMipCount(image.m_width, image.m_height);
+    }
+
+    void TextureStreamer::Start(TextureData& texture, bimg::ImageContainer* image)
+    {
+        Cancel(texture);
+
+        const auto format = static_cast<bgfx::TextureFormat::Enum>(image->m_format);
+        const uint64_t flags = TextureFlags | (image->m_srgb ? BGFX_TEXTURE_SRGB : BGFX_TEXTURE_NONE);
+
+        // The mips of a single image are stored one after the other, so the small ones are a single range.
+        uint8_t firstMip{0};
+        while (std::max(image->m_width >> firstMip, image->m_height >> firstMip) > InitialMipSize)
+        {
+            ++firstMip;
+        }
+        const bimg::ImageMip initialMip = GetMip(*image, firstMip);
+        const auto initialSize = static_cast<uint32_t>(static_cast<const uint8_t*>(image->m_data) + image->m_size - initialMip.m_data);
+
+        texture.Handle = bgfx::createTexture2D(static_cast<uint16_t>(initialMip.m_width), static_cast<uint16_t>(initialMip.m_height), firstMip + 1 < image->m_numMips, 1, format, flags, bgfx::copy(initialMip.m_data, initialSize));
+        texture.Width = image->m_width;
+        texture.Height = image->m_height;
+        texture.Tracked.Track(ResourceType::Texture, initialSize);
+
+        // Created without data, so that its mips can be updated as they are uploaded.
+        const bgfx::TextureHandle completeHandle = bgfx::createTexture2D(static_cast<uint16_t>(image->m_width), static_cast<uint16_t>(image->m_height), true, 1, format, flags);
+        m_jobs.push_back({&texture, image, completeHandle, static_cast<uint8_t>(image->m_numMips - 1), 0});
+    }
+
+    void TextureStreamer::Cancel(const TextureData& texture)
+    {
+        const auto it = std::find_if(m_jobs.begin(), m_jobs.end(), [&texture](const Job& job) {
+            return job.Texture == &texture;
+        });
+
+        if (it != m_jobs.end())
+        {
+            Abandon(*it);
+            m_jobs.erase(it);
+        }
+    }
+
+    void TextureStreamer::Clear()
+    {
+        for (auto& job : m_jobs)
+        {
+            Abandon(job);
+        }
+        m_jobs.clear();
+    }
+
+    void TextureStreamer::Update(const std::function<void(bgfx::TextureHandle)>& retire)
+    {
+        uint32_t budget{m_frameBudget};
+        while (!m_jobs.empty() && budget > 0)
+        {
+            Job& job = m_jobs.front();
+
+            bool finished{false};
+            budget -= std::min(budget, Upload(job, budget, finished));
+            if (finished)
+            {
+                const bgfx::TextureHandle initialHandle = job.Texture->Handle;
+                job.Texture->Handle = job.CompleteHandle;
+                job.Texture->Tracked.Track(ResourceType::Texture, job.Image->m_size);
+                retire(initialHandle);
+
+                bimg::imageFree(job.Image);
+                m_jobs.pop_front();
+            }
+        }
+    }
+
+    uint32_t TextureStreamer::Upload(Job& job, uint32_t budget, bool& finished)
+    {
+        const bimg::ImageMip mip = GetMip(*job.Image, job.Mip);
+
+        // Compressed mips go up in whole rows of blocks; a mip smaller than a block goes up at once.
+        const uint32_t blockHeight = bimg::getBlockInfo(mip.m_format).blockHeight;
+        const uint32_t blockRows = mip.m_height % blockHeight == 0 ? mip.m_height / blockHeight : 1;
+        const uint32_t rowHeight = blockRows == 1 ? mip.m_height : blockHeight;
+        const uint32_t rowPitch = mip.m_size / blockRows;
+
+        const uint32_t rows = std::min(blockRows - job.Row, std::max(budget / rowPitch, 1u));
+        bgfx::updateTexture2D(
+            job.CompleteHandle,
+            0,
+            job.Mip,
+            0,
+            static_cast<uint16_t>(job.Row * rowHeight),
+            static_cast<uint16_t>(mip.m_width),
+            static_cast<uint16_t>(rows * rowHeight),
+            bgfx::copy(mip.m_data + job.Row * rowPitch, rows * rowPitch));
+
+        job.Row += rows;
+        if (job.Row == blockRows)
+        {
+            job.Row = 0;
+            if (job.Mip == 0)
+            {
+                finished = true;
+            }
+            else
+            {
+                --job.Mip;
+            }
+        }
+
+        return rows * rowPitch;
+    }
+
+    void TextureStreamer::Abandon(Job& job)
+    {
+        bgfx::destroy(job.CompleteHandle);
+        bimg::imageFree(job.Image);
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <bimg/bimg.h>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+namespace Babylon
+{
+    struct TextureData;
+
+    /// Uploads large textures progressively. A streamed texture is first created from just its smallest mips, which
+    /// are cheap to upload and let it be drawn right away. The complete texture is then filled in over the following
+    /// frames, a few rows at a time within a budget of bytes per frame, and replaces the small one once every mip
+    /// has been uploaded.
+    class TextureStreamer final
+    {
+    public:
+        /// Largest width or height of the mips uploaded up front.
+        static constexpr uint32_t InitialMipSize{128};
+
+        static constexpr uint32_t DefaultFrameBudget{4 * 1024 * 1024};
+
+        TextureStreamer() = default;
+        ~TextureStreamer();
+
+        TextureStreamer(const TextureStreamer&) = delete;
+        TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+        /// Returns whether image is worth streaming: a single 2D image with a complete mip chain larger than
+        /// InitialMipSize.
+        static bool CanStream(const bimg::ImageContainer& image);
+
+        /// Creates texture from the smallest mips of image and queues the rest for upload. Takes ownership of image.
+        void Start(TextureData& texture, bimg::ImageContainer* image);
+
+        /// Stops streaming into texture, which keeps showing its smallest mips.
+        void Cancel(const TextureData& texture);
+
+        /// Stops streaming into every texture.
+        void Clear();
+
+        /// Uploads queued mips up to the frame budget. Textures that were completed get their complete texture,
+        /// and the handle each of them had before is passed to retire.
+        void Update(const std::function<void(bgfx::TextureHandle)>& retire);
+
+        void SetFrameBudget(uint32_t bytes)
+        {
+            m_frameBudget = bytes;
+        }
+
+    private:
+        struct Job
+        {
+            TextureData* Texture{};
+            bimg::ImageContainer* Image{};
+            bgfx::TextureHandle CompleteHandle{bgfx::kInvalidHandle};
+
+            /// Mips are uploaded from the smallest to the largest, each in bands of rows of blocks.
+            uint8_t Mip{};
+            uint32_t Row{};
+        };
+
+        /// Uploads at least one band of the job's current mip, returning the bytes uploaded.
+        static uint32_t Upload(Job& job, uint32_t budget, bool& finished);
+        static void Abandon(Job& job);
+
+        std::deque<Job> m_jobs{};
+        uint32_t m_frameBudget{DefaultFrameBudget};
+    };
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <bx/simd_t.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace Babylon
+{
+    /// Conversion of the typed arrays JavaScript sets uniform arrays with into the vec4 per element layout bgfx
+    /// expects. Arrays of float vec4s already have that layout and are used as they are.
+    namespace UniformArrays
+    {
+        /// Loads four consecutive components, which need not be aligned.
+        template<typename ElementT>
+        bx::simd128_t LoadComponents(const ElementT* source)
+        {
+            bx::simd128_t value;
+            std::memcpy(&value, source, sizeof(value));
+            return value;
+        }
+
+        template<typename ElementT>
+        bx::simd128_t ToFloat(bx::simd128_t value)
+        {
+            if constexpr (std::is_same_v<ElementT, int32_t>)
+            {
+                return bx::simd_itof(value);
+            }
+            else
+            {
+                return value;
+            }
+        }
+
+        /// Widens tightly packed elements of one to four int32 or float components into zero-padded vec4s,
+        /// the layout bgfx expects for uniform arrays. A trailing partial element is padded like the others.
+        /// Returns the number of vec4s written, which is componentCount / size rounded up.
+        template<int size, typename ElementT>
+        size_t WidenToVec4(const ElementT* source, size_t componentCount, bx::simd128_t* destination)
+        {
+            static_assert(size >= 1 && size <= 4);
+
+            bx::simd128_t* output = destination;
+            size_t component = 0;
+
+            // Four components are loaded at once, for as long as four are left to read. Padding is done on the
+            // bits, before int32 values are converted, so that it is the same for both element types.
+            if constexpr (size == 1)
+            {
+                const bx::simd128_t maskX = bx::simd_ild(UINT32_MAX, 0, 0, 0);
+                for (; component + 4 <= componentCount; component += 4)
+                {
+                    const bx::simd128_t values = LoadComponents(source + component);
+                    *output++ = ToFloat<ElementT>(bx::simd_and(values, maskX));
+                    *output++ = ToFloat<ElementT>(bx::simd_and(bx::simd_swiz_yyyy(values), maskX));
+                    *output++ = ToFloat<ElementT>(bx::simd_and(bx::simd_swiz_zzzz(values), maskX));
+                    *output++ = ToFloat<ElementT>(bx::simd_and(bx::simd_swiz_wwww(values), maskX));
+                }
+            }
+            else if constexpr (size == 2)
+            {
+                const bx::simd128_t zero = bx::simd_zero();
+                for (; component + 4 <= componentCount; component += 4)
+                {
+                    const bx::simd128_t values = LoadComponents(source + component);
+                    *output++ = ToFloat<ElementT>(bx::simd_shuf_xyAB(values, zero));
+                    *output++ = ToFloat<ElementT>(bx::simd_shuf_zwCD(values, zero));
+                }
+            }
+            else if constexpr (size == 3)
+            {
+                // Each load also reads the first component of the next element, which the mask clears.
+                const bx::simd128_t maskXyz = bx::simd_ild(UINT32_MAX, UINT32_MAX, UINT32_MAX, 0);
+                for (; component + 4 <= componentCount; component += 3)
+                {
+                    *output++ = ToFloat<ElementT>(bx::simd_and(LoadComponents(source + component), maskXyz));
+                }
+            }
+            else
+            {
+                for (; component + 4 <= componentCount; component += 4)
+                {
+                    *output++ = ToFloat<ElementT>(LoadComponents(source + component));
+                }
+            }
+
+            for (; component < componentCount; component += size)
+            {
+                ElementT values[4]{};
+                std::copy_n(source + component, std::min<size_t>(size, componentCount - component), values);
+                *output++ = ToFloat<ElementT>(LoadComponents(values));
+            }
+
+            return static_cast<size_t>(output - destination);
+        }
+    }
+}
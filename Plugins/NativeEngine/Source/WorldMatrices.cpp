@@ -0,0 +1,210 @@
+#include "WorldMatrices.h"
+#include "ParallelFor.h"
+
+#include <bx/simd_t.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace Babylon::WorldMatrices
+{
+    namespace
+    {
+        // Below this many nodes per thread at one depth the thread pool costs more than it saves.
+        constexpr size_t MinChunkSize{1024};
+
+        constexpr uint32_t UnknownDepth{std::numeric_limits<uint32_t>::max()};
+        constexpr uint32_t PendingDepth{UnknownDepth - 1};
+
+        bx::simd128_t LoadUnaligned(const float* source)
+        {
+            // Typed arrays are only 4-byte aligned; the copies compile to unaligned loads and stores.
+            alignas(16) float values[4];
+            std::memcpy(values, source, sizeof(values));
+            return bx::simd_ld(values);
+        }
+
+        void StoreUnaligned(float* destination, bx::simd128_t value)
+        {
+            alignas(16) float values[4];
+            bx::simd_st(values, value);
+            std::memcpy(destination, values, sizeof(values));
+        }
+
+        // Same terms as Babylon's Matrix.ComposeToRef; the fourth column is always (0, 0, 0, 1).
+        void ComposeLocal(const float* translation, const float* rotation, const float* scaling, float (&local)[4][3])
+        {
+            const float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+            const float x2 = x + x, y2 = y + y, z2 = z + z;
+            const float xx = x * x2, xy = x * y2, xz = x * z2;
+            const float yy = y * y2, yz = y * z2, zz = z * z2;
+            const float wx = w * x2, wy = w * y2, wz = w * z2;
+
+            local[0][0] = (1.f - (yy + zz)) * scaling[0];
+            local[0][1] = (xy + wz) * scaling[0];
+            local[0][2] = (xz - wy) * scaling[0];
+
+            local[1][0] = (xy - wz) * scaling[1];
+            local[1][1] = (1.f - (xx + zz)) * scaling[1];
+            local[1][2] = (yz + wx) * scaling[1];
+
+            local[2][0] = (xz + wy) * scaling[2];
+            local[2][1] = (yz - wx) * scaling[2];
+            local[2][2] = (1.f - (xx + yy)) * scaling[2];
+
+            local[3][0] = translation[0];
+            local[3][1] = translation[1];
+            local[3][2] = translation[2];
+        }
+
+        void ComposeNode(size_t node, gsl::span<const float> translations, gsl::span<const float> rotations, gsl::span<const float> scalings, gsl::span<const int32_t> parents, float* worlds)
+        {
+            float local[4][3];
+            ComposeLocal(translations.data() + node * 3, rotations.data() + node * 4, scalings.data() + node * 3, local);
+
+            float* world = worlds + node * 16;
+            const int32_t parent = parents[node];
+            if (parent < 0)
+            {
+                const float rows[16]{
+                    local[0][0], local[0][1], local[0][2], 0.f,
+                    local[1][0], local[1][1], local[1][2], 0.f,
+                    local[2][0], local[2][1], local[2][2], 0.f,
+                    local[3][0], local[3][1], local[3][2], 1.f};
+                std::memcpy(world, rows, sizeof(rows));
+                return;
+            }
+
+            // Each row of local * parent is a weighted sum of the parent's rows.
+            const float* parentWorld = worlds + static_cast<size_t>(parent) * 16;
+            const bx::simd128_t parentRows[4]{
+                LoadUnaligned(parentWorld),
+                LoadUnaligned(parentWorld + 4),
+                LoadUnaligned(parentWorld + 8),
+                LoadUnaligned(parentWorld + 12)};
+
+            for (size_t row = 0; row < 4; ++row)
+            {
+                bx::simd128_t result = row == 3 ? parentRows[3] : bx::simd_zero();
+                result = bx::simd_madd(bx::simd_splat(local[row][2]), parentRows[2], result);
+                result = bx::simd_madd(bx::simd_splat(local[row][1]), parentRows[1], result);
+                result = bx::simd_madd(bx::simd_splat(local[row][0]), parentRows[0], result);
+                StoreUnaligned(world + row * 4, result);
+            }
+        }
+
+        // Returns the nodes ordered by depth in the hierarchy, and the offset in that order at which each depth starts.
+        void SortByDepth(gsl::span<const int32_t> parents, std::vector<uint32_t>& order, std::vector<size_t>& depthOffsets)
+        {
+            const size_t count = static_cast<size_t>(parents.size());
+
+            std::vector<uint32_t> depths(count, UnknownDepth);
+            std::vector<uint32_t> chain{};
+            uint32_t maxDepth{0};
+
+            for (size_t node = 0; node < count; ++node)
+            {
+                // Walk up to the first ancestor of known depth, then assign depths back down the walked chain.
+                uint32_t depth{0};
+                size_t current = node;
+                while (true)
+                {
+                    if (depths[current] == PendingDepth)
+                    {
+                        throw std::runtime_error{"Node hierarchy contains a cycle."};
+                    }
+
+                    if (depths[current] != UnknownDepth)
+                    {
+                        depth = depths[current] + 1;
+                        break;
+                    }
+
+                    depths[current] = PendingDepth;
+                    chain.push_back(static_cast<uint32_t>(current));
+
+                    const int32_t parent = parents[current];
+                    if (parent < 0)
+                    {
+                        break;
+                    }
+
+                    if (static_cast<size_t>(parent) >= count)
+                    {
+                        throw std::runtime_error{"Parent index is out of range."};
+                    }
+
+                    current = static_cast<size_t>(parent);
+                }
+
+                for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+                {
+                    depths[*it] = depth++;
+                }
+
+                if (!chain.empty())
+                {
+                    maxDepth = std::max(maxDepth, depth - 1);
+                }
+
+                chain.clear();
+            }
+
+            depthOffsets.assign(count == 0 ? 1 : maxDepth + 2, 0);
+            for (const uint32_t depth : depths)
+            {
+                ++depthOffsets[depth + 1];
+            }
+
+            for (size_t depth = 1; depth < depthOffsets.size(); ++depth)
+            {
+                depthOffsets[depth] += depthOffsets[depth - 1];
+            }
+
+            std::vector<size_t> next{depthOffsets.begin(), depthOffsets.end() - 1};
+            order.resize(count);
+            for (size_t node = 0; node < count; ++node)
+            {
+                order[next[depths[node]]++] = static_cast<uint32_t>(node);
+            }
+        }
+    }
+
+    void Compose(gsl::span<const float> translations, gsl::span<const float> rotations, gsl::span<const float> scalings, gsl::span<const int32_t> parents, gsl::span<float> worlds)
+    {
+        const size_t count = static_cast<size_t>(parents.size());
+        if (static_cast<size_t>(translations.size()) / 3 < count || static_cast<size_t>(scalings.size()) / 3 < count)
+        {
+            throw std::runtime_error{"Translation and scaling arrays must hold three floats per node."};
+        }
+
+        if (static_cast<size_t>(rotations.size()) / 4 < count)
+        {
+            throw std::runtime_error{"Rotation array must hold a quaternion per node."};
+        }
+
+        if (static_cast<size_t>(worlds.size()) / 16 < count)
+        {
+            throw std::runtime_error{"World matrix array must hold sixteen floats per node."};
+        }
+
+        std::vector<uint32_t> order{};
+        std::vector<size_t> depthOffsets{};
+        SortByDepth(parents, order, depthOffsets);
+
+        // Nodes at one depth only read the matrices of the depth above, so each depth is a parallel batch.
+        for (size_t depth = 0; depth + 1 < depthOffsets.size(); ++depth)
+        {
+            const size_t first = depthOffsets[depth];
+            ParallelFor(depthOffsets[depth + 1] - first, MinChunkSize, 1, [&, first](size_t begin, size_t end) {
+                for (size_t index = first + begin; index < first + end; ++index)
+                {
+                    ComposeNode(order[index], translations, rotations, scalings, parents, worlds.data());
+                }
+            });
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <gsl/gsl>
+
+#include <cstdint>
+
+namespace Babylon
+{
+    /// Composition of node hierarchies into world matrices, vectorized with bx's SIMD types and spread across the
+    /// thread pool for large hierarchies.
+    ///
+    /// Matrices are 16 floats laid out as Babylon lays them out: row-major for row vectors, with the translation in
+    /// elements 12 to 14. Each local matrix is scaling * rotation * translation, and each world matrix is
+    /// local * parent world, matching Babylon's TransformNode.computeWorldMatrix without pivots or billboarding.
+    namespace WorldMatrices
+    {
+        /// Writes the world matrix of each of parents.size() nodes to worlds. Translations and scalings hold three
+        /// floats per node and rotations hold a quaternion (x, y, z, w) per node. Each parent is the index of the
+        /// node's parent, or negative for a root. Nodes may come in any order; they are grouped by depth so that
+        /// every parent is composed before its children, and the nodes of each depth are composed in parallel.
+        void Compose(gsl::span<const float> translations, gsl::span<const float> rotations, gsl::span<const float> scalings, gsl::span<const int32_t> parents, gsl::span<float> worlds);
+    }
+}